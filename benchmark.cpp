@@ -0,0 +1,889 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <mutex>
+#include <thread>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <stdexcept>
+#include "common/rectangle.hpp"
+#include "common/circle.hpp"
+#include "common/composite-shape.hpp"
+#include "common/matrix.hpp"
+#include "common/circle-batch.hpp"
+#include "common/rectangle-batch.hpp"
+#include "common/variant-composite-shape.hpp"
+#include "common/arena.hpp"
+#include "common/bounding-hierarchy.hpp"
+#include "common/composite-snapshot.hpp"
+#include "common/concurrent-composite-shape.hpp"
+#include "common/sweep-and-prune.hpp"
+#include "common/scene-format.hpp"
+#include "common/scene-view.hpp"
+#include "common/scene-text.hpp"
+#include "common/svg-writer.hpp"
+
+const size_t MAX_LINEAR_SCAN_SIZE = 10000;
+const double AVERAGE_SIDE = 4.0;
+const size_t TRANSFORM_CHAIN_SIZE = 50;
+const size_t GROUP_GRID_SIZE = 32;
+const size_t GROUP_SIZE = 8;
+const size_t QUERY_COUNT = 100;
+const size_t PRODUCER_COUNT = 4;
+const char SCENE_FILE[] = "benchmark-scene.bin";
+const char SVG_FILE[] = "benchmark-scene.svg";
+
+std::atomic<size_t> heapAllocations(0);
+
+void* operator new(size_t size)
+{
+  ++heapAllocations;
+  void *pointer = std::malloc(size == 0 ? 1 : size);
+  if (!pointer)
+  {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+  std::free(pointer);
+}
+
+golovin::CompositeShape makeScene(size_t count)
+{
+  std::mt19937 generator(static_cast<unsigned int>(count));
+  std::uniform_real_distribution<double> position(0.0, std::sqrt(static_cast<double>(count)) * AVERAGE_SIDE);
+  std::uniform_real_distribution<double> side(AVERAGE_SIDE / 4.0, AVERAGE_SIDE * 1.75);
+  golovin::CompositeShape scene;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const golovin::point_t center{position(generator), position(generator)};
+    if (i % 2 == 0)
+    {
+      scene.pushBack(std::make_shared<golovin::Rectangle>(center, side(generator), side(generator)));
+    }
+    else
+    {
+      scene.pushBack(std::make_shared<golovin::Circle>(center, side(generator) / 2.0));
+    }
+  }
+  return scene;
+}
+
+template <typename Function>
+double measure(Function function)
+{
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  function();
+  const std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+void printResult(const std::string &name, size_t count, double milliseconds)
+{
+  std::cout << name << " [" << count << "]: " << milliseconds << " ms\n";
+}
+
+void benchmarkMatrix(size_t count)
+{
+  const golovin::CompositeShape scene = makeScene(count);
+  if (count <= MAX_LINEAR_SCAN_SIZE)
+  {
+    printResult("MatrixShape::addShape", count, measure([&scene]()
+    {
+      golovin::MatrixShape matrix;
+      for (size_t i = 0; i < scene.getSize(); ++i)
+      {
+        matrix.addShape(scene[i]);
+      }
+    }));
+  }
+  printResult("MatrixShape::addShape (indexed)", count, measure([&scene]()
+  {
+    golovin::MatrixShape matrix;
+    matrix.enableIndex(AVERAGE_SIDE * 2.0);
+    for (size_t i = 0; i < scene.getSize(); ++i)
+    {
+      matrix.addShape(scene[i]);
+    }
+  }));
+  printResult("MatrixShape(const CompositeShape &)", count, measure([&scene]()
+  {
+    golovin::MatrixShape matrix(scene);
+  }));
+  golovin::ThreadPool pool;
+  printResult("MatrixShape(const CompositeShape &, ThreadPool &) x" + std::to_string(pool.getThreadCount()), count,
+      measure([&scene, &pool]()
+  {
+    golovin::MatrixShape matrix(scene, pool);
+  }));
+}
+
+void benchmarkComposite(size_t count)
+{
+  golovin::CompositeShape scene = makeScene(count);
+  printResult("CompositeShape::getArea", count, measure([&scene]()
+  {
+    scene.getArea();
+  }));
+  printResult("CompositeShape::getFrameRect", count, measure([&scene]()
+  {
+    scene.getFrameRect();
+  }));
+  golovin::ThreadPool pool;
+  printResult("CompositeShape::getArea(ThreadPool &) x" + std::to_string(pool.getThreadCount()), count,
+      measure([&scene, &pool]()
+  {
+    scene.getArea(pool);
+  }));
+  printResult("CompositeShape::getFrameRect(ThreadPool &) x" + std::to_string(pool.getThreadCount()), count,
+      measure([&scene, &pool]()
+  {
+    scene.getFrameRect(pool);
+  }));
+  printResult("CompositeShape::scale", count, measure([&scene]()
+  {
+    scene.scale(1.5);
+  }));
+  printResult("CompositeShape::rotate", count, measure([&scene]()
+  {
+    scene.rotate(30.0);
+  }));
+  printResult("CompositeShape::move", count, measure([&scene]()
+  {
+    scene.move({1.0, 1.0});
+  }));
+  printResult("CompositeShape 100 transforms", count, measure([&scene]()
+  {
+    for (size_t i = 0; i < TRANSFORM_CHAIN_SIZE; ++i)
+    {
+      scene.move(1.0, 1.0);
+      scene.rotate(1.0);
+    }
+    scene.getArea();
+  }));
+  scene.setDeferred(true);
+  printResult("CompositeShape 100 transforms (deferred)", count, measure([&scene]()
+  {
+    for (size_t i = 0; i < TRANSFORM_CHAIN_SIZE; ++i)
+    {
+      scene.move(1.0, 1.0);
+      scene.rotate(1.0);
+    }
+    scene.getArea();
+  }));
+}
+
+void benchmarkBatch(size_t count)
+{
+  std::mt19937 generator(static_cast<unsigned int>(count));
+  std::uniform_real_distribution<double> position(0.0, std::sqrt(static_cast<double>(count)) * AVERAGE_SIDE);
+  std::uniform_real_distribution<double> side(AVERAGE_SIDE / 4.0, AVERAGE_SIDE * 1.75);
+  golovin::CompositeShape circles;
+  golovin::CompositeShape rectangles;
+  golovin::CircleBatch circleBatch;
+  golovin::RectangleBatch rectangleBatch;
+  circleBatch.reserve(count);
+  rectangleBatch.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const golovin::point_t center{position(generator), position(generator)};
+    const double width = side(generator);
+    const double height = side(generator);
+    circles.pushBack(std::make_shared<golovin::Circle>(center, width / 2.0));
+    circleBatch.pushBack(center, width / 2.0);
+    rectangles.pushBack(std::make_shared<golovin::Rectangle>(center, width, height));
+    rectangleBatch.pushBack(center, width, height);
+  }
+  printResult("CompositeShape<Circle>::getArea", count, measure([&circles]()
+  {
+    circles.getArea();
+  }));
+  printResult("CircleBatch::getArea", count, measure([&circleBatch]()
+  {
+    circleBatch.getArea();
+  }));
+  printResult("CompositeShape<Circle>::getFrameRect", count, measure([&circles]()
+  {
+    circles.getFrameRect();
+  }));
+  printResult("CircleBatch::getFrameRect", count, measure([&circleBatch]()
+  {
+    circleBatch.getFrameRect();
+  }));
+  printResult("CompositeShape<Rectangle>::getArea", count, measure([&rectangles]()
+  {
+    rectangles.getArea();
+  }));
+  printResult("RectangleBatch::getArea", count, measure([&rectangleBatch]()
+  {
+    rectangleBatch.getArea();
+  }));
+  printResult("CompositeShape<Rectangle>::rotate", count, measure([&rectangles]()
+  {
+    rectangles.rotate(30.0);
+  }));
+  printResult("RectangleBatch::rotate", count, measure([&rectangleBatch]()
+  {
+    rectangleBatch.rotate(30.0);
+  }));
+  printResult("CompositeShape<Rectangle>::getFrameRect", count, measure([&rectangles]()
+  {
+    rectangles.getFrameRect();
+  }));
+  printResult("RectangleBatch::getFrameRect", count, measure([&rectangleBatch]()
+  {
+    rectangleBatch.getFrameRect();
+  }));
+}
+
+void benchmarkVariant(size_t count)
+{
+  const golovin::CompositeShape source = makeScene(count);
+  std::vector<size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(static_cast<unsigned int>(count)));
+  golovin::CompositeShape scene;
+  golovin::VariantCompositeShape variant;
+  variant.reserve(count);
+  for (size_t i : order)
+  {
+    scene.pushBack(source[i]);
+    if (i % 2 == 0)
+    {
+      variant.pushBack(*std::static_pointer_cast<golovin::Rectangle>(source[i]));
+    }
+    else
+    {
+      variant.pushBack(*std::static_pointer_cast<golovin::Circle>(source[i]));
+    }
+  }
+  printResult("CompositeShape::getArea", count, measure([&scene]()
+  {
+    scene.getArea();
+  }));
+  printResult("VariantCompositeShape::getArea", count, measure([&variant]()
+  {
+    variant.getArea();
+  }));
+  printResult("CompositeShape::getFrameRect", count, measure([&scene]()
+  {
+    scene.getFrameRect();
+  }));
+  printResult("VariantCompositeShape::getFrameRect", count, measure([&variant]()
+  {
+    variant.getFrameRect();
+  }));
+  printResult("CompositeShape::rotate", count, measure([&scene]()
+  {
+    scene.rotate(30.0);
+  }));
+  printResult("VariantCompositeShape::rotate", count, measure([&variant]()
+  {
+    variant.rotate(30.0);
+  }));
+}
+
+template <typename Factory>
+void buildScene(golovin::CompositeShape &scene, size_t count, Factory factory)
+{
+  std::mt19937 generator(static_cast<unsigned int>(count));
+  std::uniform_real_distribution<double> position(0.0, std::sqrt(static_cast<double>(count)) * AVERAGE_SIDE);
+  std::uniform_real_distribution<double> side(AVERAGE_SIDE / 4.0, AVERAGE_SIDE * 1.75);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const golovin::point_t center{position(generator), position(generator)};
+    scene.pushBack(factory(i, center, side(generator), side(generator)));
+  }
+}
+
+void benchmarkArena(size_t count)
+{
+  size_t allocations = heapAllocations;
+  golovin::CompositeShape *heapScene = nullptr;
+  golovin::MatrixShape *heapMatrix = nullptr;
+  printResult("Scene load (heap)", count, measure([&heapScene, count]()
+  {
+    heapScene = new golovin::CompositeShape();
+    buildScene(*heapScene, count, [](size_t i, const golovin::point_t &center, double width, double height)
+        -> golovin::CompositeShape::shapePointer
+    {
+      if (i % 2 == 0)
+      {
+        return std::make_shared<golovin::Rectangle>(center, width, height);
+      }
+      return std::make_shared<golovin::Circle>(center, width / 2.0);
+    });
+  }));
+  printResult("MatrixShape build (heap)", count, measure([&heapScene, &heapMatrix]()
+  {
+    heapMatrix = new golovin::MatrixShape(*heapScene);
+  }));
+  std::cout << "  heap allocations: " << heapAllocations - allocations << "\n";
+  printResult("Scene teardown (heap)", count, measure([&heapScene, &heapMatrix]()
+  {
+    delete heapMatrix;
+    delete heapScene;
+  }));
+
+  golovin::Arena arena;
+  golovin::CompositeShape *arenaScene = nullptr;
+  golovin::MatrixShape *arenaMatrix = nullptr;
+  allocations = heapAllocations;
+  printResult("Scene load (arena)", count, measure([&arena, &arenaScene, count]()
+  {
+    arenaScene = new golovin::CompositeShape(arena);
+    buildScene(*arenaScene, count, [&arena](size_t i, const golovin::point_t &center, double width, double height)
+        -> golovin::CompositeShape::shapePointer
+    {
+      if (i % 2 == 0)
+      {
+        return golovin::makeShape<golovin::Rectangle>(arena, center, width, height);
+      }
+      return golovin::makeShape<golovin::Circle>(arena, center, width / 2.0);
+    });
+  }));
+  printResult("MatrixShape build (arena)", count, measure([&arena, &arenaScene, &arenaMatrix]()
+  {
+    arenaMatrix = new golovin::MatrixShape(*arenaScene, arena);
+  }));
+  std::cout << "  heap allocations: " << heapAllocations - allocations << ", arena allocations: "
+      << arena.getAllocationCount() << " in " << arena.getBlockCount() << " blocks\n";
+  printResult("Scene teardown (arena)", count, measure([&arena, &arenaScene, &arenaMatrix]()
+  {
+    delete arenaMatrix;
+    delete arenaScene;
+    arena.release();
+  }));
+}
+
+void benchmarkInsertion(size_t count)
+{
+  std::vector<golovin::CompositeShape::shapePointer> shapes;
+  shapes.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    shapes.push_back(std::make_shared<golovin::Circle>(golovin::point_t{static_cast<double>(i), 0.0}, 1.0));
+  }
+  golovin::CompositeShape copied;
+  size_t allocations = heapAllocations;
+  printResult("CompositeShape::pushBack(const shapePointer &)", count, measure([&shapes, &copied]()
+  {
+    for (const golovin::CompositeShape::shapePointer &shape : shapes)
+    {
+      copied.pushBack(shape);
+    }
+  }));
+  std::cout << "  heap allocations: " << heapAllocations - allocations << "\n";
+  golovin::CompositeShape moved;
+  allocations = heapAllocations;
+  printResult("CompositeShape::reserve + append(move_iterator)", count, measure([&shapes, &moved]()
+  {
+    moved.reserve(shapes.size());
+    moved.append(std::make_move_iterator(shapes.begin()), std::make_move_iterator(shapes.end()));
+  }));
+  std::cout << "  heap allocations: " << heapAllocations - allocations << "\n";
+  golovin::CompositeShape emplaced;
+  allocations = heapAllocations;
+  printResult("CompositeShape::reserve + emplaceBack<Circle>", count, measure([&emplaced, count]()
+  {
+    emplaced.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      emplaced.emplaceBack<golovin::Circle>(golovin::point_t{static_cast<double>(i), 0.0}, 1.0);
+    }
+  }));
+  std::cout << "  heap allocations: " << heapAllocations - allocations << "\n";
+}
+
+void benchmarkHierarchy(size_t count)
+{
+  const golovin::CompositeShape scene = makeScene(count);
+  golovin::CompositeShape root;
+  std::vector<std::shared_ptr<golovin::CompositeShape>> groups;
+  for (size_t i = 0; i < GROUP_GRID_SIZE * GROUP_GRID_SIZE; ++i)
+  {
+    groups.push_back(std::make_shared<golovin::CompositeShape>());
+    root.pushBack(groups.back());
+  }
+  const golovin::rectangle_t frame = scene.getFrameRect();
+  for (size_t i = 0; i < count; ++i)
+  {
+    const golovin::point_t pos = scene[i]->getPos();
+    const size_t column = std::min(GROUP_GRID_SIZE - 1, static_cast<size_t>((pos.x - frame.pos.x + frame.width / 2.0)
+        / frame.width * GROUP_GRID_SIZE));
+    const size_t row = std::min(GROUP_GRID_SIZE - 1, static_cast<size_t>((pos.y - frame.pos.y + frame.height / 2.0)
+        / frame.height * GROUP_GRID_SIZE));
+    groups[row * GROUP_GRID_SIZE + column]->pushBack(scene[i]);
+  }
+  golovin::BoundingHierarchy *hierarchy = nullptr;
+  printResult("BoundingHierarchy(const CompositeShape &)", count, measure([&root, &hierarchy]()
+  {
+    hierarchy = new golovin::BoundingHierarchy(root);
+  }));
+  printResult("CompositeShape full frame after edit x" + std::to_string(QUERY_COUNT), count,
+      measure([&root, &scene]()
+  {
+    for (size_t i = 0; i < QUERY_COUNT; ++i)
+    {
+      scene[i]->move(0.5, 0.5);
+      root.getFrameRect();
+    }
+  }));
+  printResult("BoundingHierarchy::refit + getFrameRect x" + std::to_string(QUERY_COUNT), count,
+      measure([&hierarchy, &scene]()
+  {
+    for (size_t i = 0; i < QUERY_COUNT; ++i)
+    {
+      scene[i]->move(0.5, 0.5);
+      hierarchy->refit(scene[i]);
+      hierarchy->getFrameRect();
+    }
+  }));
+  std::vector<golovin::CompositeShape::shapePointer> found;
+  printResult("Point query by scan x" + std::to_string(QUERY_COUNT), count, measure([&scene, &found]()
+  {
+    for (size_t i = 0; i < QUERY_COUNT; ++i)
+    {
+      const golovin::point_t point = scene[i]->getPos();
+      found.clear();
+      for (size_t j = 0; j < scene.getSize(); ++j)
+      {
+        const golovin::rectangle_t frame = scene[j]->getFrameRect();
+        if ((std::fabs(frame.pos.x - point.x) <= frame.width / 2.0)
+            && (std::fabs(frame.pos.y - point.y) <= frame.height / 2.0))
+        {
+          found.push_back(scene[j]);
+        }
+      }
+    }
+  }));
+  printResult("BoundingHierarchy::queryPoint x" + std::to_string(QUERY_COUNT), count,
+      measure([&hierarchy, &scene, &found]()
+  {
+    for (size_t i = 0; i < QUERY_COUNT; ++i)
+    {
+      hierarchy->queryPoint(scene[i]->getPos(), found);
+    }
+  }));
+  printResult("Hit test by contains scan x" + std::to_string(QUERY_COUNT), count, measure([&scene, &found]()
+  {
+    for (size_t i = 0; i < QUERY_COUNT; ++i)
+    {
+      const golovin::point_t point = scene[i]->getPos();
+      found.clear();
+      for (size_t j = 0; j < scene.getSize(); ++j)
+      {
+        if (scene[j]->contains(point))
+        {
+          found.push_back(scene[j]);
+        }
+      }
+    }
+  }));
+  printResult("BoundingHierarchy::queryContaining x" + std::to_string(QUERY_COUNT), count,
+      measure([&hierarchy, &scene, &found]()
+  {
+    for (size_t i = 0; i < QUERY_COUNT; ++i)
+    {
+      hierarchy->queryContaining(scene[i]->getPos(), found);
+    }
+  }));
+  delete hierarchy;
+}
+
+void benchmarkSnapshot(size_t count)
+{
+  const golovin::CompositeShape scene = makeScene(count);
+  std::shared_ptr<golovin::Shape> clone;
+  printResult("CompositeShape::clone", count, measure([&scene, &clone]()
+  {
+    clone = scene.clone();
+  }));
+  golovin::CompositeSnapshot current(scene);
+  std::vector<golovin::CompositeSnapshot> frames;
+  printResult("CompositeSnapshot copy + edit x" + std::to_string(QUERY_COUNT), count,
+      measure([&current, &frames, count]()
+  {
+    for (size_t i = 0; i < QUERY_COUNT; ++i)
+    {
+      frames.push_back(current);
+      current.edit(i * count / QUERY_COUNT).move(1.0, 1.0);
+    }
+  }));
+}
+
+template <typename Function>
+void runProducers(size_t count, Function produce)
+{
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < PRODUCER_COUNT; ++t)
+  {
+    threads.emplace_back([&produce, t, count]()
+    {
+      produce(count * t / PRODUCER_COUNT, count * (t + 1) / PRODUCER_COUNT);
+    });
+  }
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+}
+
+void benchmarkIngest(size_t count)
+{
+  const golovin::CompositeShape source = makeScene(count);
+  golovin::CompositeShape locked;
+  std::mutex mutex;
+  printResult("CompositeShape::pushBack under mutex x" + std::to_string(PRODUCER_COUNT), count,
+      measure([&source, &locked, &mutex, count]()
+  {
+    runProducers(count, [&source, &locked, &mutex](size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        locked.pushBack(source[i]);
+      }
+    });
+  }));
+  golovin::ConcurrentCompositeShape concurrent;
+  golovin::CompositeShape sealed;
+  printResult("ConcurrentCompositeShape::Producer + seal x" + std::to_string(PRODUCER_COUNT), count,
+      measure([&source, &concurrent, &sealed, count]()
+  {
+    runProducers(count, [&source, &concurrent](size_t begin, size_t end)
+    {
+      golovin::ConcurrentCompositeShape::Producer producer(concurrent);
+      for (size_t i = begin; i < end; ++i)
+      {
+        producer.pushBack(source[i]);
+      }
+    });
+    sealed = concurrent.seal();
+  }));
+}
+
+void benchmarkBroadPhase(size_t count)
+{
+  const golovin::CompositeShape scene = makeScene(count);
+  std::vector<golovin::SweepAndPrune::pair_t> pairs;
+  if (count <= MAX_LINEAR_SCAN_SIZE)
+  {
+    printResult("All pairs by frame scan", count, measure([&scene, &pairs]()
+    {
+      pairs.clear();
+      for (size_t i = 0; i < scene.getSize(); ++i)
+      {
+        const golovin::rectangle_t lhs = scene[i]->getFrameRect();
+        for (size_t j = i + 1; j < scene.getSize(); ++j)
+        {
+          if (golovin::SweepAndPrune::isOverlapped(lhs, scene[j]->getFrameRect()))
+          {
+            pairs.push_back({i, j});
+          }
+        }
+      }
+    }));
+  }
+  golovin::SweepAndPrune broadPhase;
+  printResult("SweepAndPrune::update (first)", count, measure([&scene, &broadPhase, &pairs]()
+  {
+    broadPhase.update(scene, pairs);
+  }));
+  std::mt19937 generator(static_cast<unsigned int>(count));
+  std::uniform_real_distribution<double> step(-AVERAGE_SIDE / 8.0, AVERAGE_SIDE / 8.0);
+  for (size_t i = 0; i < scene.getSize(); ++i)
+  {
+    scene[i]->move(step(generator), step(generator));
+  }
+  printResult("SweepAndPrune::update (after small moves)", count, measure([&scene, &broadPhase, &pairs]()
+  {
+    broadPhase.update(scene, pairs);
+  }));
+}
+
+void benchmarkSceneFormat(size_t count)
+{
+  const golovin::CompositeShape scene = makeScene(count);
+  std::stringstream stream;
+  printResult("scene::save", count, measure([&scene, &stream]()
+  {
+    golovin::scene::save(stream, scene);
+  }));
+  const std::string bytes = stream.str();
+  std::cout << "scene size [" << count << "]: " << bytes.size() / (1024.0 * 1024.0) << " MiB\n";
+  golovin::CompositeShape loaded;
+  printResult("scene::loadComposite", count, measure([&stream, &loaded]()
+  {
+    loaded = golovin::scene::loadComposite(stream);
+  }));
+  golovin::Arena arena;
+  std::stringstream arenaStream(bytes);
+  golovin::CompositeShape arenaLoaded;
+  printResult("scene::loadComposite (arena)", count, measure([&arenaStream, &arena, &arenaLoaded]()
+  {
+    arenaLoaded = golovin::scene::loadComposite(arenaStream, arena);
+  }));
+}
+
+void benchmarkSceneView(size_t count)
+{
+  {
+    std::ofstream out(SCENE_FILE, std::ios::binary);
+    golovin::scene::save(out, makeScene(count));
+  }
+  golovin::CompositeShape loaded;
+  printResult("scene::loadComposite from file", count, measure([&loaded]()
+  {
+    std::ifstream in(SCENE_FILE, std::ios::binary);
+    loaded = golovin::scene::loadComposite(in);
+  }));
+  golovin::SceneView *view = nullptr;
+  printResult("SceneView(path)", count, measure([&view]()
+  {
+    view = new golovin::SceneView(SCENE_FILE);
+  }));
+  double area = 0.0;
+  printResult("CompositeShape::getArea (loaded)", count, measure([&loaded, &area]()
+  {
+    area += loaded.getArea();
+  }));
+  printResult("SceneView::getArea", count, measure([&view, &area]()
+  {
+    area += view->getArea();
+  }));
+  printResult("CompositeShape::getFrameRect (loaded)", count, measure([&loaded, &area]()
+  {
+    area += loaded.getFrameRect().width;
+  }));
+  printResult("SceneView::getFrameRect", count, measure([&view, &area]()
+  {
+    area += view->getFrameRect().width;
+  }));
+  std::vector<golovin::ShapeRecord> records;
+  printResult("SceneView::getLayer + contains", count, measure([&view, &records, &area]()
+  {
+    view->getLayer(0, records);
+    for (const golovin::ShapeRecord &record : records)
+    {
+      area += record.contains({0.0, 0.0}) ? 1.0 : 0.0;
+    }
+  }));
+  delete view;
+  std::remove(SCENE_FILE);
+}
+
+void benchmarkSceneText(size_t count)
+{
+  std::mt19937 generator(static_cast<unsigned int>(count));
+  std::uniform_real_distribution<double> position(0.0, std::sqrt(static_cast<double>(count)) * AVERAGE_SIDE);
+  std::uniform_real_distribution<double> side(AVERAGE_SIDE / 4.0, AVERAGE_SIDE * 1.75);
+  std::string text;
+  char line[256];
+  for (size_t i = 0; i < count; ++i)
+  {
+    const double x = position(generator);
+    const double y = position(generator);
+    const double size = side(generator);
+    const int length = (i % 2 == 0)
+        ? std::snprintf(line, sizeof(line), "RECTANGLE (%.6f %.6f, %.6f %.6f)\n", x, y, size, side(generator))
+        : std::snprintf(line, sizeof(line), "TRIANGLE ((%.6f %.6f, %.6f %.6f, %.6f %.6f, %.6f %.6f))\n",
+            x, y, x + size, y, x, y + size, x, y);
+    text.append(line, length);
+  }
+  const double megabytes = text.size() / (1024.0 * 1024.0);
+  golovin::CompositeShape baseline;
+  std::istringstream baselineStream(text);
+  const double baselineTime = measure([&baselineStream, &baseline]()
+  {
+    std::string keyword;
+    char separator = 0;
+    double values[8];
+    while (baselineStream >> keyword)
+    {
+      if (keyword == "RECTANGLE")
+      {
+        baselineStream >> separator >> values[0] >> values[1] >> separator >> values[2] >> values[3] >> separator;
+        baseline.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{values[0], values[1]},
+            values[2], values[3]));
+      }
+      else
+      {
+        baselineStream >> separator >> separator;
+        for (size_t i = 0; i < 8; i += 2)
+        {
+          baselineStream >> values[i] >> values[i + 1] >> separator;
+        }
+        baselineStream >> separator;
+        baseline.pushBack(std::make_shared<golovin::Triangle>(golovin::point_t{values[0], values[1]},
+            golovin::point_t{values[2], values[3]}, golovin::point_t{values[4], values[5]}));
+      }
+    }
+  });
+  printResult("Text scene by operator>> (" + std::to_string(static_cast<int>(megabytes / baselineTime * 1000.0))
+      + " MB/s)", count, baselineTime);
+  golovin::CompositeShape parsed;
+  std::istringstream stream(text);
+  const double parseTime = measure([&stream, &parsed]()
+  {
+    golovin::scene::parseText(stream, parsed);
+  });
+  printResult("scene::parseText (" + std::to_string(static_cast<int>(megabytes / parseTime * 1000.0)) + " MB/s)",
+      count, parseTime);
+}
+
+void benchmarkSvg(size_t count)
+{
+  const golovin::CompositeShape scene = makeScene(count);
+  const golovin::MatrixShape matrix(scene);
+  printResult("SVG by operator<<", count, measure([&matrix]()
+  {
+    std::ofstream out(SVG_FILE);
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      out << "<g id=\"layer-" << i << "\">\n";
+      for (const golovin::MatrixShape::shapePointer &shape : matrix[i])
+      {
+        const golovin::rectangle_t frame = shape->getFrameRect();
+        out << "<rect x=\"" << frame.pos.x - frame.width / 2.0 << "\" y=\"" << frame.pos.y - frame.height / 2.0
+            << "\" width=\"" << frame.width << "\" height=\"" << frame.height << "\"/>\n";
+      }
+      out << "</g>\n";
+    }
+  }));
+  golovin::SvgWriter writer;
+  printResult("SvgWriter::write(MatrixShape)", count, measure([&matrix, &writer]()
+  {
+    std::ofstream out(SVG_FILE);
+    writer.write(out, matrix);
+  }));
+  std::remove(SVG_FILE);
+}
+
+void benchmarkFrameStatus(size_t count)
+{
+  std::vector<std::shared_ptr<golovin::CompositeShape>> groups;
+  for (size_t i = 0; i < count / GROUP_SIZE; ++i)
+  {
+    groups.push_back(std::make_shared<golovin::CompositeShape>());
+    for (size_t j = 0; j < GROUP_SIZE; ++j)
+    {
+      groups.back()->emplaceBack<golovin::Circle>(golovin::point_t{1.0 * i, 1.0 * j}, 1.0);
+    }
+    if (i % 2 == 0)
+    {
+      groups.back()->emplaceBack<golovin::CompositeShape>();
+    }
+  }
+  size_t failures = 0;
+  printResult("getFrameRect + catch (half of groups fail)", count, measure([&groups, &failures]()
+  {
+    for (const std::shared_ptr<golovin::CompositeShape> &group : groups)
+    {
+      try
+      {
+        group->getFrameRect();
+      }
+      catch (const std::logic_error &)
+      {
+        ++failures;
+      }
+    }
+  }));
+  printResult("tryGetFrameRect (half of groups fail)", count, measure([&groups, &failures]()
+  {
+    golovin::rectangle_t frame{};
+    for (const std::shared_ptr<golovin::CompositeShape> &group : groups)
+    {
+      failures += group->tryGetFrameRect(frame) ? 0 : 1;
+    }
+  }));
+  const golovin::MatrixShape matrix(makeScene(count));
+  double area = 0.0;
+  printResult("MatrixShape layer sweep, bounds-checked", count, measure([&matrix, &area]()
+  {
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      const golovin::LayerView layer = matrix[i];
+      for (size_t j = 0; j < layer.getSize(); ++j)
+      {
+        area += layer[j]->getArea();
+      }
+    }
+  }));
+  printResult("MatrixShape layer sweep, unchecked", count, measure([&matrix, &area]()
+  {
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      const golovin::LayerView layer = matrix.getUnchecked(i);
+      for (size_t j = 0; j < layer.getSize(); ++j)
+      {
+        area += layer.getUnchecked(j)->getArea();
+      }
+    }
+  }));
+  std::cout << "  (" << failures << " failures, area " << area << ")\n";
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      benchmarkMatrix(std::stoul(argv[i]));
+      benchmarkComposite(std::stoul(argv[i]));
+      benchmarkBatch(std::stoul(argv[i]));
+      benchmarkVariant(std::stoul(argv[i]));
+      benchmarkArena(std::stoul(argv[i]));
+      benchmarkInsertion(std::stoul(argv[i]));
+      benchmarkHierarchy(std::stoul(argv[i]));
+      benchmarkSnapshot(std::stoul(argv[i]));
+      benchmarkIngest(std::stoul(argv[i]));
+      benchmarkBroadPhase(std::stoul(argv[i]));
+      benchmarkSceneFormat(std::stoul(argv[i]));
+      benchmarkSceneView(std::stoul(argv[i]));
+      benchmarkSceneText(std::stoul(argv[i]));
+      benchmarkSvg(std::stoul(argv[i]));
+      benchmarkFrameStatus(std::stoul(argv[i]));
+    }
+    return 0;
+  }
+  const size_t sizes[] = {10000, 100000, 1000000};
+  for (size_t count : sizes)
+  {
+    benchmarkMatrix(count);
+    benchmarkComposite(count);
+    benchmarkBatch(count);
+    benchmarkVariant(count);
+    benchmarkArena(count);
+    benchmarkInsertion(count);
+    benchmarkHierarchy(count);
+    benchmarkSnapshot(count);
+    benchmarkIngest(count);
+    benchmarkBroadPhase(count);
+    benchmarkSceneFormat(count);
+    benchmarkSceneView(count);
+    benchmarkSceneText(count);
+    benchmarkSvg(count);
+    benchmarkFrameStatus(count);
+  }
+  return 0;
+}
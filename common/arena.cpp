@@ -0,0 +1,104 @@
+#include "arena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+const size_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+golovin::Arena::Arena():
+  Arena(DEFAULT_BLOCK_SIZE)
+{}
+
+golovin::Arena::Arena(size_t blockSize):
+  initialBlockSize_(blockSize),
+  nextBlockSize_(blockSize),
+  blocks_(nullptr),
+  current_(nullptr),
+  remaining_(0),
+  allocationCount_(0),
+  blockCount_(0),
+  usedBytes_(0)
+{
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("Block size of the arena must be > 0");
+  }
+}
+
+golovin::Arena::~Arena()
+{
+  release();
+}
+
+void* golovin::Arena::allocate(size_t bytes, size_t alignment)
+{
+  if ((alignment == 0) || ((alignment & (alignment - 1)) != 0))
+  {
+    throw std::invalid_argument("Alignment must be a power of two");
+  }
+  size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+  if ((current_ == nullptr) || (padding > remaining_) || (bytes > remaining_ - padding))
+  {
+    const size_t required = bytes + alignment + sizeof(block_t);
+    if (required > nextBlockSize_ / 2)
+    {
+      unsigned char *data = reinterpret_cast<unsigned char *>(allocateBlock(required) + 1);
+      ++allocationCount_;
+      usedBytes_ += bytes;
+      return data + (alignment - reinterpret_cast<std::uintptr_t>(data) % alignment) % alignment;
+    }
+    block_t *block = allocateBlock(nextBlockSize_);
+    current_ = reinterpret_cast<unsigned char *>(block + 1);
+    remaining_ = block->size - sizeof(block_t);
+    nextBlockSize_ = std::min(MAX_BLOCK_SIZE, nextBlockSize_ * 2);
+    padding = (alignment - reinterpret_cast<std::uintptr_t>(current_) % alignment) % alignment;
+  }
+  unsigned char *result = current_ + padding;
+  current_ = result + bytes;
+  remaining_ -= padding + bytes;
+  ++allocationCount_;
+  usedBytes_ += bytes;
+  return result;
+}
+
+void golovin::Arena::release() noexcept
+{
+  while (blocks_ != nullptr)
+  {
+    block_t *next = blocks_->next;
+    ::operator delete(blocks_);
+    blocks_ = next;
+  }
+  nextBlockSize_ = initialBlockSize_;
+  current_ = nullptr;
+  remaining_ = 0;
+  allocationCount_ = 0;
+  blockCount_ = 0;
+  usedBytes_ = 0;
+}
+
+size_t golovin::Arena::getAllocationCount() const noexcept
+{
+  return allocationCount_;
+}
+
+size_t golovin::Arena::getBlockCount() const noexcept
+{
+  return blockCount_;
+}
+
+size_t golovin::Arena::getUsedBytes() const noexcept
+{
+  return usedBytes_;
+}
+
+golovin::Arena::block_t* golovin::Arena::allocateBlock(size_t size)
+{
+  block_t *block = static_cast<block_t *>(::operator new(size));
+  block->next = blocks_;
+  block->size = size;
+  blocks_ = block;
+  ++blockCount_;
+  return block;
+}
@@ -0,0 +1,126 @@
+#ifndef A4_ARENA_HPP
+#define A4_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <limits>
+#include <utility>
+#include <type_traits>
+
+namespace golovin
+{
+  class Arena
+  {
+  public:
+    Arena();
+
+    explicit Arena(size_t blockSize);
+
+    Arena(const Arena &) = delete;
+
+    ~Arena();
+
+    Arena& operator=(const Arena &) = delete;
+
+    void* allocate(size_t bytes, size_t alignment);
+
+    void release() noexcept;
+
+    size_t getAllocationCount() const noexcept;
+
+    size_t getBlockCount() const noexcept;
+
+    size_t getUsedBytes() const noexcept;
+
+  private:
+    struct block_t
+    {
+      block_t *next;
+      size_t size;
+    };
+
+    size_t initialBlockSize_;
+    size_t nextBlockSize_;
+    block_t *blocks_;
+    unsigned char *current_;
+    size_t remaining_;
+    size_t allocationCount_;
+    size_t blockCount_;
+    size_t usedBytes_;
+
+    block_t* allocateBlock(size_t size);
+  };
+
+  template <typename T>
+  class ArenaAllocator
+  {
+  public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator() noexcept:
+      arena_(nullptr)
+    {}
+
+    ArenaAllocator(Arena &arena) noexcept:
+      arena_(&arena)
+    {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &src) noexcept:
+      arena_(src.getArena())
+    {}
+
+    T* allocate(size_t count)
+    {
+      if (count > std::numeric_limits<size_t>::max() / sizeof(T))
+      {
+        throw std::bad_array_new_length();
+      }
+      if (!arena_)
+      {
+        return static_cast<T *>(::operator new(count * sizeof(T)));
+      }
+      return static_cast<T *>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, size_t) noexcept
+    {
+      if (!arena_)
+      {
+        ::operator delete(pointer);
+      }
+    }
+
+    Arena* getArena() const noexcept
+    {
+      return arena_;
+    }
+
+  private:
+    Arena *arena_;
+  };
+
+  template <typename T, typename U>
+  bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+  {
+    return lhs.getArena() == rhs.getArena();
+  }
+
+  template <typename T, typename U>
+  bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  template <typename T, typename... Args>
+  std::shared_ptr<T> makeShape(Arena &arena, Args &&... args)
+  {
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+  }
+}
+
+#endif //A4_ARENA_HPP
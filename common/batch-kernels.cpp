@@ -0,0 +1,261 @@
+#include "batch-kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX__)
+typedef __m256d vector_t;
+const size_t WIDTH = 4;
+
+static inline vector_t load(const double *source) { return _mm256_loadu_pd(source); }
+static inline void store(double *destination, vector_t value) { _mm256_storeu_pd(destination, value); }
+static inline vector_t broadcast(double value) { return _mm256_set1_pd(value); }
+static inline vector_t add(vector_t lhs, vector_t rhs) { return _mm256_add_pd(lhs, rhs); }
+static inline vector_t subtract(vector_t lhs, vector_t rhs) { return _mm256_sub_pd(lhs, rhs); }
+static inline vector_t product(vector_t lhs, vector_t rhs) { return _mm256_mul_pd(lhs, rhs); }
+static inline vector_t quotient(vector_t lhs, vector_t rhs) { return _mm256_div_pd(lhs, rhs); }
+static inline vector_t root(vector_t value) { return _mm256_sqrt_pd(value); }
+static inline vector_t minimum(vector_t lhs, vector_t rhs) { return _mm256_min_pd(lhs, rhs); }
+static inline vector_t maximum(vector_t lhs, vector_t rhs) { return _mm256_max_pd(lhs, rhs); }
+static inline vector_t absolute(vector_t value) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), value); }
+static inline void unpack(vector_t value, double *destination) { _mm256_storeu_pd(destination, value); }
+#elif defined(__SSE2__)
+typedef __m128d vector_t;
+const size_t WIDTH = 2;
+
+static inline vector_t load(const double *source) { return _mm_loadu_pd(source); }
+static inline void store(double *destination, vector_t value) { _mm_storeu_pd(destination, value); }
+static inline vector_t broadcast(double value) { return _mm_set1_pd(value); }
+static inline vector_t add(vector_t lhs, vector_t rhs) { return _mm_add_pd(lhs, rhs); }
+static inline vector_t subtract(vector_t lhs, vector_t rhs) { return _mm_sub_pd(lhs, rhs); }
+static inline vector_t product(vector_t lhs, vector_t rhs) { return _mm_mul_pd(lhs, rhs); }
+static inline vector_t quotient(vector_t lhs, vector_t rhs) { return _mm_div_pd(lhs, rhs); }
+static inline vector_t root(vector_t value) { return _mm_sqrt_pd(value); }
+static inline vector_t minimum(vector_t lhs, vector_t rhs) { return _mm_min_pd(lhs, rhs); }
+static inline vector_t maximum(vector_t lhs, vector_t rhs) { return _mm_max_pd(lhs, rhs); }
+static inline vector_t absolute(vector_t value) { return _mm_andnot_pd(_mm_set1_pd(-0.0), value); }
+static inline void unpack(vector_t value, double *destination) { _mm_storeu_pd(destination, value); }
+#else
+typedef double vector_t;
+const size_t WIDTH = 1;
+
+static inline vector_t load(const double *source) { return *source; }
+static inline void store(double *destination, vector_t value) { *destination = value; }
+static inline vector_t broadcast(double value) { return value; }
+static inline vector_t add(vector_t lhs, vector_t rhs) { return lhs + rhs; }
+static inline vector_t subtract(vector_t lhs, vector_t rhs) { return lhs - rhs; }
+static inline vector_t product(vector_t lhs, vector_t rhs) { return lhs * rhs; }
+static inline vector_t quotient(vector_t lhs, vector_t rhs) { return lhs / rhs; }
+static inline vector_t root(vector_t value) { return std::sqrt(value); }
+static inline vector_t minimum(vector_t lhs, vector_t rhs) { return std::min(lhs, rhs); }
+static inline vector_t maximum(vector_t lhs, vector_t rhs) { return std::max(lhs, rhs); }
+static inline vector_t absolute(vector_t value) { return std::fabs(value); }
+static inline void unpack(vector_t value, double *destination) { *destination = value; }
+#endif
+
+static double sumLanes(vector_t value)
+{
+  double lanes[WIDTH];
+  unpack(value, lanes);
+  double sum = 0.0;
+  for (size_t i = 0; i < WIDTH; ++i)
+  {
+    sum += lanes[i];
+  }
+  return sum;
+}
+
+static double minLanes(vector_t value)
+{
+  double lanes[WIDTH];
+  unpack(value, lanes);
+  return *std::min_element(lanes, lanes + WIDTH);
+}
+
+static double maxLanes(vector_t value)
+{
+  double lanes[WIDTH];
+  unpack(value, lanes);
+  return *std::max_element(lanes, lanes + WIDTH);
+}
+
+double golovin::kernels::sumOfProducts(const double *lhs, const double *rhs, size_t count) noexcept
+{
+  vector_t first = broadcast(0.0);
+  vector_t second = broadcast(0.0);
+  size_t i = 0;
+  for (; i + 2 * WIDTH <= count; i += 2 * WIDTH)
+  {
+    first = add(first, product(load(lhs + i), load(rhs + i)));
+    second = add(second, product(load(lhs + i + WIDTH), load(rhs + i + WIDTH)));
+  }
+  double sum = sumLanes(add(first, second));
+  for (; i < count; ++i)
+  {
+    sum += lhs[i] * rhs[i];
+  }
+  return sum;
+}
+
+golovin::kernels::bounds_t golovin::kernels::getBounds(const double *xs, const double *ys, const double *radii,
+    size_t count) noexcept
+{
+  vector_t minX = broadcast(std::numeric_limits<double>::max());
+  vector_t maxX = broadcast(std::numeric_limits<double>::lowest());
+  vector_t minY = minX;
+  vector_t maxY = maxX;
+  size_t i = 0;
+  for (; i + WIDTH <= count; i += WIDTH)
+  {
+    const vector_t radius = load(radii + i);
+    const vector_t x = load(xs + i);
+    const vector_t y = load(ys + i);
+    minX = minimum(minX, subtract(x, radius));
+    maxX = maximum(maxX, add(x, radius));
+    minY = minimum(minY, subtract(y, radius));
+    maxY = maximum(maxY, add(y, radius));
+  }
+  bounds_t bounds{minLanes(minX), maxLanes(maxX), minLanes(minY), maxLanes(maxY)};
+  for (; i < count; ++i)
+  {
+    bounds.minX = std::min(bounds.minX, xs[i] - radii[i]);
+    bounds.maxX = std::max(bounds.maxX, xs[i] + radii[i]);
+    bounds.minY = std::min(bounds.minY, ys[i] - radii[i]);
+    bounds.maxY = std::max(bounds.maxY, ys[i] + radii[i]);
+  }
+  return bounds;
+}
+
+golovin::kernels::bounds_t golovin::kernels::getRotatedBounds(const double *xs, const double *ys,
+    const double *widths, const double *heights, const double *cosines, const double *sines, size_t count) noexcept
+{
+  const vector_t half = broadcast(0.5);
+  vector_t minX = broadcast(std::numeric_limits<double>::max());
+  vector_t maxX = broadcast(std::numeric_limits<double>::lowest());
+  vector_t minY = minX;
+  vector_t maxY = maxX;
+  size_t i = 0;
+  for (; i + WIDTH <= count; i += WIDTH)
+  {
+    const vector_t cosAngle = absolute(load(cosines + i));
+    const vector_t sinAngle = absolute(load(sines + i));
+    const vector_t width = load(widths + i);
+    const vector_t height = load(heights + i);
+    const vector_t halfWidth = product(half, add(product(height, sinAngle), product(width, cosAngle)));
+    const vector_t halfHeight = product(half, add(product(height, cosAngle), product(width, sinAngle)));
+    const vector_t x = load(xs + i);
+    const vector_t y = load(ys + i);
+    minX = minimum(minX, subtract(x, halfWidth));
+    maxX = maximum(maxX, add(x, halfWidth));
+    minY = minimum(minY, subtract(y, halfHeight));
+    maxY = maximum(maxY, add(y, halfHeight));
+  }
+  bounds_t bounds{minLanes(minX), maxLanes(maxX), minLanes(minY), maxLanes(maxY)};
+  for (; i < count; ++i)
+  {
+    const double cosAngle = std::fabs(cosines[i]);
+    const double sinAngle = std::fabs(sines[i]);
+    const double halfWidth = 0.5 * (heights[i] * sinAngle + widths[i] * cosAngle);
+    const double halfHeight = 0.5 * (heights[i] * cosAngle + widths[i] * sinAngle);
+    bounds.minX = std::min(bounds.minX, xs[i] - halfWidth);
+    bounds.maxX = std::max(bounds.maxX, xs[i] + halfWidth);
+    bounds.minY = std::min(bounds.minY, ys[i] - halfHeight);
+    bounds.maxY = std::max(bounds.maxY, ys[i] + halfHeight);
+  }
+  return bounds;
+}
+
+void golovin::kernels::shift(double *values, size_t count, double delta) noexcept
+{
+  const vector_t offset = broadcast(delta);
+  size_t i = 0;
+  for (; i + WIDTH <= count; i += WIDTH)
+  {
+    store(values + i, add(load(values + i), offset));
+  }
+  for (; i < count; ++i)
+  {
+    values[i] += delta;
+  }
+}
+
+void golovin::kernels::multiply(double *values, size_t count, double coefficient) noexcept
+{
+  const vector_t factor = broadcast(coefficient);
+  size_t i = 0;
+  for (; i + WIDTH <= count; i += WIDTH)
+  {
+    store(values + i, product(load(values + i), factor));
+  }
+  for (; i < count; ++i)
+  {
+    values[i] *= coefficient;
+  }
+}
+
+void golovin::kernels::scaleAbout(double *values, size_t count, double center, double coefficient) noexcept
+{
+  const vector_t origin = broadcast(center);
+  const vector_t factor = broadcast(coefficient);
+  size_t i = 0;
+  for (; i + WIDTH <= count; i += WIDTH)
+  {
+    store(values + i, add(origin, product(subtract(load(values + i), origin), factor)));
+  }
+  for (; i < count; ++i)
+  {
+    values[i] = center + (values[i] - center) * coefficient;
+  }
+}
+
+void golovin::kernels::rotateAbout(double *xs, double *ys, size_t count, const point_t &center,
+    double cosAngle, double sinAngle) noexcept
+{
+  const vector_t originX = broadcast(center.x);
+  const vector_t originY = broadcast(center.y);
+  const vector_t cosine = broadcast(cosAngle);
+  const vector_t sine = broadcast(sinAngle);
+  size_t i = 0;
+  for (; i + WIDTH <= count; i += WIDTH)
+  {
+    const vector_t dX = subtract(load(xs + i), originX);
+    const vector_t dY = subtract(load(ys + i), originY);
+    store(xs + i, add(originX, subtract(product(dX, cosine), product(dY, sine))));
+    store(ys + i, add(originY, add(product(dY, cosine), product(dX, sine))));
+  }
+  for (; i < count; ++i)
+  {
+    const double dX = xs[i] - center.x;
+    const double dY = ys[i] - center.y;
+    xs[i] = center.x + dX * cosAngle - dY * sinAngle;
+    ys[i] = center.y + dY * cosAngle + dX * sinAngle;
+  }
+}
+
+void golovin::kernels::normalize(double *xs, double *ys, size_t count) noexcept
+{
+  size_t i = 0;
+  for (; i + WIDTH <= count; i += WIDTH)
+  {
+    const vector_t x = load(xs + i);
+    const vector_t y = load(ys + i);
+    const vector_t length = root(add(product(x, x), product(y, y)));
+    store(xs + i, quotient(x, length));
+    store(ys + i, quotient(y, length));
+  }
+  for (; i < count; ++i)
+  {
+    const double length = std::sqrt(xs[i] * xs[i] + ys[i] * ys[i]);
+    xs[i] /= length;
+    ys[i] /= length;
+  }
+}
+
+golovin::rectangle_t golovin::kernels::toRectangle(const bounds_t &bounds) noexcept
+{
+  return {bounds.maxX - bounds.minX, bounds.maxY - bounds.minY,
+      {(bounds.maxX + bounds.minX) / 2.0, (bounds.maxY + bounds.minY) / 2.0}};
+}
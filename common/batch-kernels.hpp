@@ -0,0 +1,42 @@
+#ifndef A4_BATCH_KERNELS_HPP
+#define A4_BATCH_KERNELS_HPP
+
+#include <cstddef>
+#include "base-types.hpp"
+
+namespace golovin
+{
+  namespace kernels
+  {
+    struct bounds_t
+    {
+      double minX;
+      double maxX;
+      double minY;
+      double maxY;
+    };
+
+    double sumOfProducts(const double *lhs, const double *rhs, size_t count) noexcept;
+
+    bounds_t getBounds(const double *xs, const double *ys, const double *radii, size_t count) noexcept;
+
+    bounds_t getRotatedBounds(const double *xs, const double *ys, const double *widths, const double *heights,
+        const double *cosines, const double *sines, size_t count) noexcept;
+
+    void shift(double *values, size_t count, double delta) noexcept;
+
+    void multiply(double *values, size_t count, double coefficient) noexcept;
+
+    void scaleAbout(double *values, size_t count, double center, double coefficient) noexcept;
+
+    void rotateAbout(double *xs, double *ys, size_t count, const point_t &center,
+        double cosAngle, double sinAngle) noexcept;
+
+    //Scales every (x, y) pair to unit length; the pairs must not be zero.
+    void normalize(double *xs, double *ys, size_t count) noexcept;
+
+    rectangle_t toRectangle(const bounds_t &) noexcept;
+  }
+}
+
+#endif //A4_BATCH_KERNELS_HPP
@@ -0,0 +1,243 @@
+#include "bounding-hierarchy.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+const size_t NO_NODE = std::numeric_limits<size_t>::max();
+const size_t MAX_GROUP_SIZE = 4;
+
+golovin::BoundingHierarchy::BoundingHierarchy(const CompositeShape &composite):
+  root_(NO_NODE),
+  leafCount_(0)
+{
+  root_ = buildComposite(composite, nullptr);
+  if (root_ == NO_NODE)
+  {
+    throw std::invalid_argument("Composite shape must be not empty");
+  }
+}
+
+void golovin::BoundingHierarchy::rebuild(const CompositeShape &composite)
+{
+  *this = BoundingHierarchy(composite);
+}
+
+golovin::rectangle_t golovin::BoundingHierarchy::getFrameRect() const noexcept
+{
+  return kernels::toRectangle(nodes_[root_].bounds);
+}
+
+void golovin::BoundingHierarchy::refit(const shapePointer &shape)
+{
+  typedef std::unordered_multimap<const Shape *, size_t>::const_iterator idIterator;
+  const std::pair<idIterator, idIterator> range = ids_.equal_range(shape.get());
+  if (range.first == range.second)
+  {
+    throw std::invalid_argument("Shape is not in the hierarchy");
+  }
+  const CompositeShape *composite = dynamic_cast<const CompositeShape *>(shape.get());
+  if (composite)
+  {
+    composite->flush();
+  }
+  for (idIterator i = range.first; i != range.second; ++i)
+  {
+    refitSubtree(i->second);
+    for (size_t node = nodes_[i->second].parent; node != NO_NODE; node = nodes_[node].parent)
+    {
+      refitNode(node);
+    }
+  }
+}
+
+void golovin::BoundingHierarchy::queryPoint(const point_t &point, std::vector<shapePointer> &result) const
+{
+  query([&point](const kernels::bounds_t &bounds)
+  {
+    return (bounds.minX <= point.x) && (point.x <= bounds.maxX) && (bounds.minY <= point.y) && (point.y <= bounds.maxY);
+  }, result);
+}
+
+void golovin::BoundingHierarchy::queryRectangle(const rectangle_t &rectangle, std::vector<shapePointer> &result) const
+{
+  const kernels::bounds_t area = getBounds(rectangle);
+  query([&area](const kernels::bounds_t &bounds)
+  {
+    return (bounds.minX <= area.maxX) && (area.minX <= bounds.maxX)
+        && (bounds.minY <= area.maxY) && (area.minY <= bounds.maxY);
+  }, result);
+}
+
+void golovin::BoundingHierarchy::queryContaining(const point_t &point, std::vector<shapePointer> &result) const
+{
+  queryPoint(point, result);
+  result.erase(std::remove_if(result.begin(), result.end(), [&point](const shapePointer &shape)
+  {
+    return !shape->contains(point);
+  }), result.end());
+}
+
+size_t golovin::BoundingHierarchy::getSize() const noexcept
+{
+  return leafCount_;
+}
+
+size_t golovin::BoundingHierarchy::getDepth() const noexcept
+{
+  size_t depth = 0;
+  for (size_t i = 0; i < nodes_.size(); ++i)
+  {
+    if (nodes_[i].count == 0)
+    {
+      size_t level = 1;
+      for (size_t node = nodes_[i].parent; node != NO_NODE; node = nodes_[node].parent)
+      {
+        ++level;
+      }
+      depth = std::max(depth, level);
+    }
+  }
+  return depth;
+}
+
+size_t golovin::BoundingHierarchy::buildComposite(const CompositeShape &composite, const shapePointer &self)
+{
+  std::vector<size_t> items;
+  items.reserve(composite.getSize());
+  for (size_t i = 0; i < composite.getSize(); ++i)
+  {
+    const shapePointer &child = composite[i];
+    const CompositeShape *nested = dynamic_cast<const CompositeShape *>(child.get());
+    if (nested)
+    {
+      const size_t item = buildComposite(*nested, child);
+      if (item != NO_NODE)
+      {
+        items.push_back(item);
+      }
+    }
+    else
+    {
+      items.push_back(nodes_.size());
+      ids_.emplace(child.get(), nodes_.size());
+      nodes_.push_back({child, getBounds(child->getFrameRect()), NO_NODE, 0, 0});
+      ++leafCount_;
+    }
+  }
+  if (items.empty())
+  {
+    return NO_NODE;
+  }
+  const size_t node = buildGroup(items, 0, items.size());
+  if (self)
+  {
+    nodes_[node].shape = self;
+    ids_.emplace(self.get(), node);
+  }
+  return node;
+}
+
+size_t golovin::BoundingHierarchy::buildGroup(std::vector<size_t> &items, size_t begin, size_t end)
+{
+  size_t group[MAX_GROUP_SIZE];
+  size_t count = end - begin;
+  if (count <= MAX_GROUP_SIZE)
+  {
+    std::copy(items.begin() + begin, items.begin() + end, group);
+  }
+  else
+  {
+    kernels::bounds_t centers{std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+        std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()};
+    for (size_t i = begin; i < end; ++i)
+    {
+      const kernels::bounds_t &bounds = nodes_[items[i]].bounds;
+      centers.minX = std::min(centers.minX, bounds.minX + bounds.maxX);
+      centers.maxX = std::max(centers.maxX, bounds.minX + bounds.maxX);
+      centers.minY = std::min(centers.minY, bounds.minY + bounds.maxY);
+      centers.maxY = std::max(centers.maxY, bounds.minY + bounds.maxY);
+    }
+    const bool isHorizontal = (centers.maxX - centers.minX) >= (centers.maxY - centers.minY);
+    const std::vector<node_t> &nodes = nodes_;
+    const size_t middle = begin + count / 2;
+    std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+        [&nodes, isHorizontal](size_t lhs, size_t rhs)
+    {
+      const kernels::bounds_t &first = nodes[lhs].bounds;
+      const kernels::bounds_t &second = nodes[rhs].bounds;
+      return isHorizontal ? (first.minX + first.maxX < second.minX + second.maxX)
+          : (first.minY + first.maxY < second.minY + second.maxY);
+    });
+    group[0] = buildGroup(items, begin, middle);
+    group[1] = buildGroup(items, middle, end);
+    count = 2;
+  }
+  const size_t node = nodes_.size();
+  nodes_.push_back({nullptr, nodes_[group[0]].bounds, NO_NODE, children_.size(), count});
+  for (size_t i = 0; i < count; ++i)
+  {
+    nodes_[group[i]].parent = node;
+    children_.push_back(group[i]);
+  }
+  refitNode(node);
+  return node;
+}
+
+void golovin::BoundingHierarchy::refitSubtree(size_t node)
+{
+  if (nodes_[node].count == 0)
+  {
+    nodes_[node].bounds = getBounds(nodes_[node].shape->getFrameRect());
+    return;
+  }
+  for (size_t i = nodes_[node].first; i < nodes_[node].first + nodes_[node].count; ++i)
+  {
+    refitSubtree(children_[i]);
+  }
+  refitNode(node);
+}
+
+void golovin::BoundingHierarchy::refitNode(size_t node) noexcept
+{
+  const size_t first = nodes_[node].first;
+  kernels::bounds_t bounds = nodes_[children_[first]].bounds;
+  for (size_t i = first + 1; i < first + nodes_[node].count; ++i)
+  {
+    const kernels::bounds_t &child = nodes_[children_[i]].bounds;
+    bounds.minX = std::min(bounds.minX, child.minX);
+    bounds.maxX = std::max(bounds.maxX, child.maxX);
+    bounds.minY = std::min(bounds.minY, child.minY);
+    bounds.maxY = std::max(bounds.maxY, child.maxY);
+  }
+  nodes_[node].bounds = bounds;
+}
+
+template <typename Predicate>
+void golovin::BoundingHierarchy::query(Predicate isHit, std::vector<shapePointer> &result) const
+{
+  result.clear();
+  std::vector<size_t> stack(1, root_);
+  while (!stack.empty())
+  {
+    const node_t &node = nodes_[stack.back()];
+    stack.pop_back();
+    if (!isHit(node.bounds))
+    {
+      continue;
+    }
+    if (node.count == 0)
+    {
+      result.push_back(node.shape);
+    }
+    else
+    {
+      stack.insert(stack.end(), children_.begin() + node.first, children_.begin() + node.first + node.count);
+    }
+  }
+}
+
+golovin::kernels::bounds_t golovin::BoundingHierarchy::getBounds(const rectangle_t &rectangle) noexcept
+{
+  return {rectangle.pos.x - rectangle.width / 2.0, rectangle.pos.x + rectangle.width / 2.0,
+      rectangle.pos.y - rectangle.height / 2.0, rectangle.pos.y + rectangle.height / 2.0};
+}
@@ -0,0 +1,68 @@
+#ifndef A4_BOUNDING_HIERARCHY_HPP
+#define A4_BOUNDING_HIERARCHY_HPP
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "shape.hpp"
+#include "base-types.hpp"
+#include "composite-shape.hpp"
+#include "batch-kernels.hpp"
+
+namespace golovin
+{
+  class BoundingHierarchy
+  {
+  public:
+    typedef std::shared_ptr<Shape> shapePointer;
+
+    explicit BoundingHierarchy(const CompositeShape &);
+
+    void rebuild(const CompositeShape &);
+
+    rectangle_t getFrameRect() const noexcept;
+
+    void refit(const shapePointer &);
+
+    void queryPoint(const point_t &, std::vector<shapePointer> &result) const;
+
+    void queryRectangle(const rectangle_t &, std::vector<shapePointer> &result) const;
+
+    void queryContaining(const point_t &, std::vector<shapePointer> &result) const;
+
+    size_t getSize() const noexcept;
+
+    size_t getDepth() const noexcept;
+
+  private:
+    struct node_t
+    {
+      shapePointer shape;
+      kernels::bounds_t bounds;
+      size_t parent;
+      size_t first;
+      size_t count;
+    };
+
+    std::vector<node_t> nodes_;
+    std::vector<size_t> children_;
+    std::unordered_multimap<const Shape *, size_t> ids_;
+    size_t root_;
+    size_t leafCount_;
+
+    size_t buildComposite(const CompositeShape &, const shapePointer &);
+
+    size_t buildGroup(std::vector<size_t> &items, size_t begin, size_t end);
+
+    void refitSubtree(size_t node);
+
+    void refitNode(size_t node) noexcept;
+
+    template <typename Predicate>
+    void query(Predicate isHit, std::vector<shapePointer> &result) const;
+
+    static kernels::bounds_t getBounds(const rectangle_t &) noexcept;
+  };
+}
+
+#endif //A4_BOUNDING_HIERARCHY_HPP
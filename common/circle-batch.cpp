@@ -0,0 +1,136 @@
+#include "circle-batch.hpp"
+#include <cmath>
+#include <stdexcept>
+#include "batch-kernels.hpp"
+
+void golovin::CircleBatch::pushBack(const point_t &center, double radius)
+{
+  if (radius <= 0.0)
+  {
+    throw std::invalid_argument("The incoming raduis of the circle must be > 0");
+  }
+  xs_.push_back(center.x);
+  ys_.push_back(center.y);
+  radii_.push_back(radius);
+}
+
+void golovin::CircleBatch::reserve(size_t capacity)
+{
+  xs_.reserve(capacity);
+  ys_.reserve(capacity);
+  radii_.reserve(capacity);
+}
+
+golovin::Circle golovin::CircleBatch::operator[](size_t index) const
+{
+  if (index >= radii_.size())
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return Circle({xs_[index], ys_[index]}, radii_[index]);
+}
+
+size_t golovin::CircleBatch::getSize() const noexcept
+{
+  return radii_.size();
+}
+
+bool golovin::CircleBatch::isEmpty() const noexcept
+{
+  return radii_.empty();
+}
+
+double golovin::CircleBatch::getArea() const noexcept
+{
+  return M_PI * kernels::sumOfProducts(radii_.data(), radii_.data(), radii_.size());
+}
+
+golovin::rectangle_t golovin::CircleBatch::getFrameRect() const
+{
+  rectangle_t frame{};
+  if (!tryGetFrameRect(frame))
+  {
+    throw std::logic_error("Array is empty");
+  }
+  return frame;
+}
+
+bool golovin::CircleBatch::tryGetFrameRect(rectangle_t &frame) const noexcept
+{
+  if (radii_.empty())
+  {
+    return false;
+  }
+  frame = kernels::toRectangle(kernels::getBounds(xs_.data(), ys_.data(), radii_.data(), radii_.size()));
+  return true;
+}
+
+void golovin::CircleBatch::scale(double coefficient)
+{
+  if (coefficient <= 0.0)
+  {
+    throw std::invalid_argument("Scaling coefficient is not positive");
+  }
+  if (radii_.empty())
+  {
+    return;
+  }
+  const point_t center = getPos();
+  kernels::scaleAbout(xs_.data(), xs_.size(), center.x, coefficient);
+  kernels::scaleAbout(ys_.data(), ys_.size(), center.y, coefficient);
+  kernels::multiply(radii_.data(), radii_.size(), coefficient);
+}
+
+void golovin::CircleBatch::move(const point_t &destinationPoint)
+{
+  if (radii_.empty())
+  {
+    return;
+  }
+  const point_t center = getPos();
+  move(destinationPoint.x - center.x, destinationPoint.y - center.y);
+}
+
+void golovin::CircleBatch::move(double dX, double dY) noexcept
+{
+  kernels::shift(xs_.data(), xs_.size(), dX);
+  kernels::shift(ys_.data(), ys_.size(), dY);
+}
+
+golovin::point_t golovin::CircleBatch::getPos() const
+{
+  return getFrameRect().pos;
+}
+
+void golovin::CircleBatch::rotate(double angle)
+{
+  const double PI_IN_DEGREES = 180.0;
+  if (radii_.empty())
+  {
+    return;
+  }
+  const double angleRadian = angle * (M_PI / PI_IN_DEGREES);
+  kernels::rotateAbout(xs_.data(), ys_.data(), xs_.size(), getPos(), std::cos(angleRadian), std::sin(angleRadian));
+}
+
+void golovin::CircleBatch::print(std::ostream &out) const
+{
+  out << "CircleBatch ";
+}
+
+std::shared_ptr<golovin::Shape> golovin::CircleBatch::clone() const
+{
+  return std::make_shared<CircleBatch>(*this);
+}
+
+bool golovin::CircleBatch::contains(const point_t &point) const noexcept
+{
+  bool isFound = false;
+  for (size_t i = 0; i < radii_.size(); ++i)
+  {
+    const double dX = point.x - xs_[i];
+    const double dY = point.y - ys_[i];
+    isFound |= (dX * dX + dY * dY <= radii_[i] * radii_[i]);
+  }
+  return isFound;
+}
@@ -0,0 +1,55 @@
+#ifndef A4_CIRCLE_BATCH_HPP
+#define A4_CIRCLE_BATCH_HPP
+
+#include <vector>
+#include "shape.hpp"
+#include "circle.hpp"
+#include "base-types.hpp"
+
+namespace golovin
+{
+  class CircleBatch : public Shape
+  {
+  public:
+    CircleBatch() = default;
+
+    void pushBack(const point_t &center, double radius);
+
+    void reserve(size_t capacity);
+
+    Circle operator[](size_t) const;
+
+    size_t getSize() const noexcept;
+
+    bool isEmpty() const noexcept;
+
+    double getArea() const noexcept override;
+
+    rectangle_t getFrameRect() const override;
+
+    bool tryGetFrameRect(rectangle_t &) const noexcept override;
+
+    void scale(double) override;
+
+    void move(const point_t &) override;
+
+    void move(double dX, double dY) noexcept override;
+
+    point_t getPos() const override;
+
+    void rotate(double) override;
+
+    void print(std::ostream &) const override;
+
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const noexcept override;
+
+  private:
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> radii_;
+  };
+}
+
+#endif //A4_CIRCLE_BATCH_HPP
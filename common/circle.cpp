@@ -54,3 +54,20 @@ void golovin::Circle::print(std::ostream &out) const
 {
   out << "Circle ";
 }
+
+std::shared_ptr<golovin::Shape> golovin::Circle::clone() const
+{
+  return std::make_shared<Circle>(*this);
+}
+
+bool golovin::Circle::contains(const point_t &point) const noexcept
+{
+  const double dX = point.x - center_.x;
+  const double dY = point.y - center_.y;
+  return dX * dX + dY * dY <= radius_ * radius_;
+}
+
+double golovin::Circle::getRadius() const noexcept
+{
+  return radius_;
+}
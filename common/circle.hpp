@@ -27,6 +27,12 @@ namespace golovin
 
     void print(std::ostream &) const override;
 
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const noexcept override;
+
+    double getRadius() const noexcept;
+
   private:
     point_t center_;
     double radius_;
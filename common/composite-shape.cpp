@@ -4,46 +4,112 @@
 #include <stdexcept>
 #include <exception>
 #include <string>
+#include <numeric>
+#include <typeinfo>
 #include "base-types.hpp"
+#include "batch-kernels.hpp"
+#include "thread-pool.hpp"
+
+static golovin::kernels::bounds_t getBounds(const golovin::CompositeShape::shapePointer *shapes,
+    size_t begin, size_t end)
+{
+  size_t index = begin;
+  try
+  {
+    const golovin::rectangle_t rectangle = shapes[begin]->getFrameRect();
+    golovin::kernels::bounds_t bounds{rectangle.pos.x - rectangle.width / 2.0, rectangle.pos.x + rectangle.width / 2.0,
+        rectangle.pos.y - rectangle.height / 2.0, rectangle.pos.y + rectangle.height / 2.0};
+    for (index = begin + 1; index < end; ++index)
+    {
+      const golovin::rectangle_t curr = shapes[index]->getFrameRect();
+      bounds.minX = std::min(bounds.minX, curr.pos.x - curr.width / 2.0);
+      bounds.maxX = std::max(bounds.maxX, curr.pos.x + curr.width / 2.0);
+      bounds.minY = std::min(bounds.minY, curr.pos.y - curr.height / 2.0);
+      bounds.maxY = std::max(bounds.maxY, curr.pos.y + curr.height / 2.0);
+    }
+    return bounds;
+  }
+  catch (const std::exception &e)
+  {
+    std::throw_with_nested(std::logic_error("Failed to perform operation for shape at index " + std::to_string(index)));
+  }
+}
+
+static bool tryGetBounds(const golovin::CompositeShape::shapePointer *shapes, size_t begin, size_t end,
+    golovin::kernels::bounds_t &bounds)
+{
+  golovin::rectangle_t curr{};
+  if ((begin == end) || !shapes[begin]->tryGetFrameRect(curr))
+  {
+    return false;
+  }
+  bounds = {curr.pos.x - curr.width / 2.0, curr.pos.x + curr.width / 2.0,
+      curr.pos.y - curr.height / 2.0, curr.pos.y + curr.height / 2.0};
+  for (size_t index = begin + 1; index < end; ++index)
+  {
+    if (!shapes[index]->tryGetFrameRect(curr))
+    {
+      return false;
+    }
+    bounds.minX = std::min(bounds.minX, curr.pos.x - curr.width / 2.0);
+    bounds.maxX = std::max(bounds.maxX, curr.pos.x + curr.width / 2.0);
+    bounds.minY = std::min(bounds.minY, curr.pos.y - curr.height / 2.0);
+    bounds.maxY = std::max(bounds.maxY, curr.pos.y + curr.height / 2.0);
+  }
+  return true;
+}
+
+static size_t getChunkCount(size_t size, size_t grainSize)
+{
+  if (grainSize == 0)
+  {
+    throw std::invalid_argument("Grain size must be > 0");
+  }
+  return (size + grainSize - 1) / grainSize;
+}
 
 golovin::CompositeShape::CompositeShape():
-  size_(0),
-  capacity_(1),
-  array_(std::make_unique<shapePointer[]>(capacity_))
+  CompositeShape(allocator_type())
 {}
 
+golovin::CompositeShape::CompositeShape(const allocator_type &allocator):
+  array_(allocator),
+  isDeferred_(false),
+  isFlat_(true)
+{
+  resetPending();
+}
+
 golovin::CompositeShape::CompositeShape(const CompositeShape &src):
-  size_(src.size_),
-  capacity_(src.size_),
-  array_(std::make_unique<shapePointer[]>(src.size_))
+  array_(src.array_.get_allocator()),
+  isDeferred_(src.isDeferred_),
+  isFlat_(src.isFlat_)
 {
-  for (size_t i = 0; i < src.size_; ++i)
-  {
-    array_[i] = src.array_[i];
-  }
+  resetPending();
+  src.flush();
+  array_.reserve(src.array_.capacity());
+  array_.assign(src.array_.begin(), src.array_.end());
 }
 
 golovin::CompositeShape::CompositeShape(CompositeShape &&src) noexcept:
-  size_(src.size_),
-  capacity_(src.capacity_),
-  array_(std::move(src.array_))
+  array_(std::move(src.array_)),
+  isDeferred_(src.isDeferred_),
+  isFlat_(src.isFlat_),
+  isPending_(src.isPending_),
+  pending_(src.pending_)
 {
-  src.size_ = 0;
-  src.capacity_ = 0;
+  src.array_.clear();
+  src.resetPending();
 }
 
 golovin::CompositeShape& golovin::CompositeShape::operator=(const CompositeShape &src)
 {
   if (this != &src)
   {
-    shapeArray tmpArray = std::make_unique<shapePointer[]>(src.size_);
-    size_ = src.size_;
-    capacity_= src.size_;
-    for (size_t i = 0; i < src.size_; ++i)
-    {
-      tmpArray[i] = src.array_[i];
-    }
-    array_.swap(tmpArray);
+    flush();
+    src.flush();
+    array_ = src.array_;
+    isFlat_ = src.isFlat_;
   }
   return *this;
 }
@@ -52,21 +118,45 @@ golovin::CompositeShape& golovin::CompositeShape::operator=(CompositeShape &&src
 {
   if (this != &src)
   {
-    size_ = src.size_;
-    capacity_ = src.size_;
     array_ = std::move(src.array_);
-    src.size_ = 0;
-    src.capacity_ = 0;
+    isDeferred_ = src.isDeferred_;
+    isFlat_ = src.isFlat_;
+    isPending_ = src.isPending_;
+    pending_ = src.pending_;
+    src.array_.clear();
+    src.resetPending();
   }
   return *this;
 }
 
-golovin::CompositeShape::shapePointer &golovin::CompositeShape::operator[](size_t index) const
+const golovin::CompositeShape::shapePointer &golovin::CompositeShape::operator[](size_t index) const
 {
-  if (index >= size_)
+  if (index >= array_.size())
   {
     throw std::out_of_range("Index is out of range");
   }
+  flush();
+  return array_[index];
+}
+
+golovin::CompositeShape::shapePointer &golovin::CompositeShape::operator[](size_t index)
+{
+  if (index >= array_.size())
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return getUnchecked(index);
+}
+
+const golovin::CompositeShape::shapePointer &golovin::CompositeShape::getUnchecked(size_t index) const noexcept
+{
+  return array_[index];
+}
+
+golovin::CompositeShape::shapePointer &golovin::CompositeShape::getUnchecked(size_t index)
+{
+  flush();
+  isFlat_ = false;
   return array_[index];
 }
 
@@ -76,33 +166,57 @@ void golovin::CompositeShape::pushBack(const golovin::CompositeShape::shapePoint
   {
     throw std::invalid_argument("Empty pointer");
   }
+  flush();
+  isFlat_ = isFlat_ && !isComposite(*newElement);
+  array_.push_back(newElement);
+}
 
-  if (size_ == capacity_)
+void golovin::CompositeShape::pushBack(shapePointer &&newElement)
+{
+  if (newElement == nullptr)
   {
-    shapeArray tmp(std::make_unique<shapePointer[]>(2 * capacity_));
-    for (size_t i = 0; i < size_; ++i)
-    {
-      tmp[i] = array_[i];
-    }
-    array_.swap(tmp);
-    capacity_ *= 2;
+    throw std::invalid_argument("Empty pointer");
   }
-  array_[size_++] = newElement;
+  flush();
+  isFlat_ = isFlat_ && !isComposite(*newElement);
+  array_.push_back(std::move(newElement));
+}
+
+void golovin::CompositeShape::reserve(size_t capacity)
+{
+  array_.reserve(capacity);
+}
+
+void golovin::CompositeShape::shrinkToFit()
+{
+  array_.shrink_to_fit();
+}
+
+size_t golovin::CompositeShape::getCapacity() const noexcept
+{
+  return array_.capacity();
 }
 
 void golovin::CompositeShape::popBack()
 {
-  if (size_ == 0)
+  if (array_.empty())
   {
     throw std::logic_error("Array is empty");
   }
-  array_[--size_].reset();
+  flush();
+  array_.pop_back();
+}
+
+golovin::CompositeShape::allocator_type golovin::CompositeShape::getAllocator() const noexcept
+{
+  return array_.get_allocator();
 }
 
-double golovin::CompositeShape::getArea() const noexcept
+double golovin::CompositeShape::getArea() const
 {
+  flush();
   double sum = 0.0;
-  for (size_t i = 0; i < size_; ++i)
+  for (size_t i = 0; i < array_.size(); ++i)
   {
     sum += array_[i]->getArea();
   }
@@ -111,33 +225,92 @@ double golovin::CompositeShape::getArea() const noexcept
 
 golovin::rectangle_t golovin::CompositeShape::getFrameRect() const
 {
-  if (size_ == 0)
+  flush();
+  return getChildrenFrame();
+}
+
+bool golovin::CompositeShape::tryGetFrameRect(rectangle_t &frame) const
+{
+  flush();
+  return tryComputeFrameRect(frame);
+}
+
+double golovin::CompositeShape::getArea(ThreadPool &pool, size_t grainSize) const
+{
+  const size_t chunks = getChunkCount(array_.size(), grainSize);
+  if (chunks < 2)
   {
-    throw std::logic_error("Array is empty");
+    return getArea();
   }
-  size_t index = 0;
-  try
+  flushTree();
+  std::vector<double> sums(chunks);
+  pool.run(chunks, [this, &sums, grainSize](size_t chunk)
   {
-    rectangle_t rectangle = array_[0]->getFrameRect();
-    double minX = rectangle.pos.x - rectangle.width / 2.0;
-    double maxX = rectangle.pos.x + rectangle.width / 2.0;
-    double minY = rectangle.pos.y - rectangle.height / 2.0;
-    double maxY = rectangle.pos.y + rectangle.height / 2.0;
-    for (index = 1; index < size_; ++index)
+    const size_t end = std::min(array_.size(), (chunk + 1) * grainSize);
+    double sum = 0.0;
+    for (size_t i = chunk * grainSize; i < end; ++i)
     {
-      rectangle_t curr = array_[index]->getFrameRect();
-      minX = std::min(minX, curr.pos.x - curr.width / 2.0);
-      maxX = std::max(maxX, curr.pos.x + curr.width / 2.0);
-      minY = std::min(minY, curr.pos.y - curr.height / 2.0);
-      maxY = std::max(maxY, curr.pos.y + curr.height / 2.0);
+      sum += array_[i]->getArea();
     }
-    return {std::abs(maxX - minX), std::abs(maxY - minY),
-        {(maxX + minX) / 2.0, (maxY + minY) / 2.0}};
+    sums[chunk] = sum;
+  });
+  return std::accumulate(sums.begin(), sums.end(), 0.0);
+}
+
+golovin::rectangle_t golovin::CompositeShape::getFrameRect(ThreadPool &pool, size_t grainSize) const
+{
+  const size_t chunks = getChunkCount(array_.size(), grainSize);
+  if (chunks < 2)
+  {
+    return getFrameRect();
   }
-  catch (const std::exception &e)
+  flushTree();
+  std::vector<kernels::bounds_t> parts(chunks);
+  std::vector<char> isFound(chunks);
+  pool.run(chunks, [this, &parts, &isFound, grainSize](size_t chunk)
   {
-    std::throw_with_nested(std::logic_error("Failed to perform operation for shape at index " + std::to_string(index)));
+    isFound[chunk] = tryGetBounds(array_.data(), chunk * grainSize, std::min(array_.size(), (chunk + 1) * grainSize),
+        parts[chunk]);
+  });
+  if (std::find(isFound.begin(), isFound.end(), 0) != isFound.end())
+  {
+    return getChildrenFrame();
+  }
+  kernels::bounds_t bounds = parts.front();
+  for (const kernels::bounds_t &part : parts)
+  {
+    bounds.minX = std::min(bounds.minX, part.minX);
+    bounds.maxX = std::max(bounds.maxX, part.maxX);
+    bounds.minY = std::min(bounds.minY, part.minY);
+    bounds.maxY = std::max(bounds.maxY, part.maxY);
+  }
+  return kernels::toRectangle(bounds);
+}
+
+golovin::rectangle_t golovin::CompositeShape::getChildrenFrame() const
+{
+  rectangle_t frame{};
+  return tryComputeFrameRect(frame) ? frame : computeFrameRect();
+}
+
+bool golovin::CompositeShape::tryComputeFrameRect(rectangle_t &frame) const
+{
+  kernels::bounds_t bounds{};
+  if (!tryGetBounds(array_.data(), 0, array_.size(), bounds))
+  {
+    return false;
+  }
+  frame = kernels::toRectangle(bounds);
+  return true;
+}
+
+golovin::rectangle_t golovin::CompositeShape::computeFrameRect() const
+{
+  if (array_.empty())
+  {
+    throw std::logic_error("Array is empty");
   }
+  return kernels::toRectangle(getBounds(array_.data(), 0, array_.size()));
 }
 
 void golovin::CompositeShape::scale(double coefficient)
@@ -146,26 +319,37 @@ void golovin::CompositeShape::scale(double coefficient)
   {
     throw std::invalid_argument("Scaling coefficient is not positive");
   }
-  for (size_t i = 0; i < size_; i++)
+  if (array_.empty())
   {
-    const point_t center = getFrameRect().pos;
-    double dX = array_[i]->getFrameRect().pos.x - center.x;
-    double dY = array_[i]->getFrameRect().pos.y - center.y;
-    array_[i]->move(center.x + dX * coefficient, center.y + dY * coefficient);
-    array_[i]->scale(coefficient);
+    return;
+  }
+  const point_t pivot = getPivot();
+  pending_.coefficient *= coefficient;
+  pending_.offset = {pivot.x + (pending_.offset.x - pivot.x) * coefficient,
+      pivot.y + (pending_.offset.y - pivot.y) * coefficient};
+  isPending_ = true;
+  if (!isDeferred_)
+  {
+    flush();
   }
 }
 
 void golovin::CompositeShape::move(const golovin::point_t & destinationPoint)
 {
-  double dx = destinationPoint.x - getFrameRect().pos.x;
-  double dy = destinationPoint.y - getFrameRect().pos.y;
-  move(dx, dy);
+  const point_t center = getPivot();
+  move(destinationPoint.x - center.x, destinationPoint.y - center.y);
 }
 
-void golovin::CompositeShape::move(double dX, double dY) noexcept
+void golovin::CompositeShape::move(double dX, double dY)
 {
-  for (size_t i = 0; i < size_; ++i)
+  if (isDeferred_)
+  {
+    pending_.offset.x += dX;
+    pending_.offset.y += dY;
+    isPending_ = true;
+    return;
+  }
+  for (size_t i = 0; i < array_.size(); ++i)
   {
     array_[i]->move(dX, dY);
   }
@@ -173,7 +357,7 @@ void golovin::CompositeShape::move(double dX, double dY) noexcept
 
 bool golovin::CompositeShape::isEmpty() const noexcept
 {
-  return (size_ == 0);
+  return array_.empty();
 }
 
 golovin::point_t golovin::CompositeShape::getPos() const
@@ -187,23 +371,145 @@ void golovin::CompositeShape::rotate(double angle)
   const double angleRadian = angle * (M_PI / PI_IN_DEGREES);
   const double sinAngle = std::sin(angleRadian);
   const double cosAngle = std::cos(angleRadian);
-  point_t centerShape = getFrameRect().pos;
-  for (size_t i = 0; i < size_; ++i)
+  const point_t pivot = getPivot();
+  const double dX = pending_.offset.x - pivot.x;
+  const double dY = pending_.offset.y - pivot.y;
+  pending_.offset = {pivot.x + dX * cosAngle - dY * sinAngle, pivot.y + dY * cosAngle + dX * sinAngle};
+  const double pendingCos = pending_.cosAngle;
+  pending_.cosAngle = pendingCos * cosAngle - pending_.sinAngle * sinAngle;
+  pending_.sinAngle = pending_.sinAngle * cosAngle + pendingCos * sinAngle;
+  pending_.angle += angle;
+  isPending_ = true;
+  if (!isDeferred_)
   {
-    point_t currCenter = array_[i]->getFrameRect().pos;
-    const double deltaX = centerShape.x + (currCenter.x - centerShape.x) * cosAngle - (currCenter.y - centerShape.y) * sinAngle;
-    const double deltaY = centerShape.y + (currCenter.y - centerShape.y) * cosAngle - (currCenter.x - centerShape.x) * sinAngle;
-    array_[i]->move({deltaX, deltaY});
-    array_[i]->rotate(angle);
+    flush();
   }
 }
 
 size_t golovin::CompositeShape::getSize() const noexcept
 {
-  return size_;
+  return array_.size();
 }
 
 void golovin::CompositeShape::print(std::ostream &out) const
 {
   out << "CompositeShape ";
-}
\ No newline at end of file
+}
+
+std::shared_ptr<golovin::Shape> golovin::CompositeShape::clone() const
+{
+  flush();
+  std::shared_ptr<CompositeShape> copy = std::make_shared<CompositeShape>(getAllocator());
+  copy->reserve(array_.size());
+  for (const shapePointer &shape : array_)
+  {
+    copy->array_.push_back(shape->clone());
+  }
+  copy->isDeferred_ = isDeferred_;
+  copy->isFlat_ = isFlat_;
+  return copy;
+}
+
+bool golovin::CompositeShape::contains(const point_t &point) const
+{
+  flush();
+  for (const shapePointer &shape : array_)
+  {
+    if (shape->contains(point))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void golovin::CompositeShape::setDeferred(bool isDeferred)
+{
+  isDeferred_ = isDeferred;
+  if (!isDeferred_)
+  {
+    flush();
+  }
+}
+
+bool golovin::CompositeShape::isDeferred() const noexcept
+{
+  return isDeferred_;
+}
+
+void golovin::CompositeShape::flush() const
+{
+  if (!isPending_)
+  {
+    return;
+  }
+  const transform_t transform = pending_;
+  const bool isShift = (transform.coefficient == 1.0) && (transform.angle == 0.0);
+  //Every child position is read before any child changes, so a child without a frame (an emptied
+  //nested composite) throws here and leaves the children and the pending transform untouched.
+  std::vector<point_t> positions(isShift ? 0 : array_.size());
+  for (size_t i = 0; i < positions.size(); ++i)
+  {
+    positions[i] = array_[i]->getPos();
+  }
+  for (size_t i = 0; i < array_.size(); ++i)
+  {
+    const point_t pos = isShift ? point_t{0.0, 0.0} : positions[i];
+    const point_t target{transform.offset.x + transform.coefficient * (pos.x * transform.cosAngle - pos.y * transform.sinAngle),
+        transform.offset.y + transform.coefficient * (pos.y * transform.cosAngle + pos.x * transform.sinAngle)};
+    array_[i]->move(target.x - pos.x, target.y - pos.y);
+    if (transform.coefficient != 1.0)
+    {
+      array_[i]->scale(transform.coefficient);
+    }
+    if (transform.angle != 0.0)
+    {
+      array_[i]->rotate(transform.angle);
+    }
+  }
+  resetPending();
+}
+
+void golovin::CompositeShape::flushTree() const
+{
+  flush();
+  if (isFlat_)
+  {
+    return;
+  }
+  bool isFlat = true;
+  for (const shapePointer &shape : array_)
+  {
+    if (isComposite(*shape))
+    {
+      isFlat = false;
+      static_cast<const CompositeShape &>(*shape).flushTree();
+    }
+  }
+  isFlat_ = isFlat;
+}
+
+bool golovin::CompositeShape::isComposite(const Shape &shape) noexcept
+{
+  return typeid(shape) == typeid(CompositeShape);
+}
+
+golovin::point_t golovin::CompositeShape::getPivot() const
+{
+  const double RIGHT_ANGLE = 90.0;
+  if (isPending_ && (std::fmod(pending_.angle, RIGHT_ANGLE) != 0.0))
+  {
+    flush();
+  }
+  //The children keep their untransformed positions while a transform is pending, so their frame is
+  //read on every call and mapped through it; a child changed through another pointer is seen at once.
+  const point_t center = getChildrenFrame().pos;
+  return {pending_.offset.x + pending_.coefficient * (center.x * pending_.cosAngle - center.y * pending_.sinAngle),
+      pending_.offset.y + pending_.coefficient * (center.y * pending_.cosAngle + center.x * pending_.sinAngle)};
+}
+
+void golovin::CompositeShape::resetPending() const noexcept
+{
+  isPending_ = false;
+  pending_ = {1.0, 0.0, 1.0, 0.0, {0.0, 0.0}};
+}
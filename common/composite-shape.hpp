@@ -2,17 +2,30 @@
 #define A3_COMPOSITE_SHAPE_HPP
 
 #include <memory>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
 #include "shape.hpp"
 #include "base-types.hpp"
+#include "arena.hpp"
 namespace golovin {
+  class ThreadPool;
+
   class CompositeShape : public Shape
   {
   public:
     typedef std::shared_ptr<Shape> shapePointer;
     typedef std::unique_ptr<shapePointer[]> shapeArray;
+    typedef ArenaAllocator<shapePointer> allocator_type;
+
+    static const size_t DEFAULT_GRAIN_SIZE = 4096;
 
     CompositeShape();
 
+    explicit CompositeShape(const allocator_type &);
+
     CompositeShape(const CompositeShape &);
 
     CompositeShape(CompositeShape &&) noexcept;
@@ -23,21 +36,56 @@ namespace golovin {
 
     CompositeShape& operator=(CompositeShape &&) noexcept;
 
-    shapePointer& operator[](size_t) const;
+    const shapePointer& operator[](size_t) const;
+
+    //Applies pending transforms first, since the returned child may be changed.
+    shapePointer& operator[](size_t);
+
+    //No bounds check and no flush(), so it never writes to the composite and is safe to call from
+    //several threads at once; call flush() first if transforms may be pending.
+    const shapePointer& getUnchecked(size_t) const noexcept;
+
+    shapePointer& getUnchecked(size_t);
 
     void pushBack(const shapePointer &);
 
+    void pushBack(shapePointer &&);
+
+    template <typename T, typename... Args>
+    T& emplaceBack(Args &&... args);
+
+    //Checks the whole range for empty pointers before taking anything from it, so a throw leaves both
+    //the composite and the source (even behind move iterators) untouched.
+    template <typename InputIterator>
+    void append(InputIterator first, InputIterator last);
+
+    void reserve(size_t capacity);
+
+    void shrinkToFit();
+
+    size_t getCapacity() const noexcept;
+
     void popBack();
 
-    double getArea() const noexcept override;
+    double getArea() const override;
 
     rectangle_t getFrameRect() const override;
 
+    //The frame is missing if this or any nested composite is empty; getFrameRect() then throws a nested logic_error.
+    bool tryGetFrameRect(rectangle_t &) const override;
+
+    //Sums fixed chunks of grainSize children in index order; differs from getArea() by at most
+    //2 * getSize() * DBL_EPSILON * getArea(). The frame is exact. Both call flushTree() on the calling
+    //thread first, so the pool threads only read.
+    double getArea(ThreadPool &, size_t grainSize = DEFAULT_GRAIN_SIZE) const;
+
+    rectangle_t getFrameRect(ThreadPool &, size_t grainSize = DEFAULT_GRAIN_SIZE) const;
+
     void scale(double) override;
 
     void move(const point_t &) override;
 
-    void move(double dX, double dY) noexcept override;
+    void move(double dX, double dY) override;
 
     bool isEmpty() const noexcept;
 
@@ -48,10 +96,101 @@ namespace golovin {
     void rotate(double) override;
 
     void print(std::ostream &) const override;
+
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const override;
+
+    //In deferred mode the const readers (getArea, getFrameRect, contains, const operator[], ...) apply the
+    //pending transform to the children first, so concurrent const reads of a deferred composite are not
+    //thread-safe; call flushTree() before sharing it between threads.
+    void setDeferred(bool);
+
+    bool isDeferred() const noexcept;
+
+    //Applies the pending transform. If a child has no frame to transform about, it throws before any
+    //child changes and the transform stays pending.
+    void flush() const;
+
+    //Calls flush() here and in every nested CompositeShape, so no const reader of the tree writes.
+    void flushTree() const;
+
+    allocator_type getAllocator() const noexcept;
   private:
-    size_t size_;
-    size_t capacity_;
-    shapeArray array_;
+    struct transform_t
+    {
+      double coefficient;
+      double angle;
+      double cosAngle;
+      double sinAngle;
+      point_t offset;
+    };
+
+    typedef std::vector<shapePointer, allocator_type> shapeVector;
+
+    shapeVector array_;
+    bool isDeferred_;
+    //No child is a CompositeShape, so flushTree() skips them; cleared whenever that may stop being true.
+    mutable bool isFlat_;
+    mutable bool isPending_;
+    mutable transform_t pending_;
+
+    rectangle_t computeFrameRect() const;
+
+    bool tryComputeFrameRect(rectangle_t &) const;
+
+    static bool isComposite(const Shape &) noexcept;
+
+    rectangle_t getChildrenFrame() const;
+
+    point_t getPivot() const;
+
+    void resetPending() const noexcept;
+
+    template <typename InputIterator>
+    void appendRange(InputIterator first, InputIterator last, std::input_iterator_tag);
+
+    template <typename ForwardIterator>
+    void appendRange(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag);
   };
+
+  template <typename T, typename... Args>
+  T& CompositeShape::emplaceBack(Args &&... args)
+  {
+    flush();
+    std::shared_ptr<T> shape = std::allocate_shared<T>(ArenaAllocator<T>(array_.get_allocator()),
+        std::forward<Args>(args)...);
+    T &result = *shape;
+    array_.push_back(std::move(shape));
+    isFlat_ = isFlat_ && !isComposite(result);
+    return result;
+  }
+
+  template <typename InputIterator>
+  void CompositeShape::append(InputIterator first, InputIterator last)
+  {
+    appendRange(first, last, typename std::iterator_traits<InputIterator>::iterator_category());
+  }
+
+  template <typename InputIterator>
+  void CompositeShape::appendRange(InputIterator first, InputIterator last, std::input_iterator_tag)
+  {
+    //A single-pass range can only be checked once it has been read.
+    std::vector<shapePointer> shapes(first, last);
+    appendRange(std::make_move_iterator(shapes.begin()), std::make_move_iterator(shapes.end()),
+        std::forward_iterator_tag());
+  }
+
+  template <typename ForwardIterator>
+  void CompositeShape::appendRange(ForwardIterator first, ForwardIterator last, std::forward_iterator_tag)
+  {
+    if (std::find(first, last, nullptr) != last)
+    {
+      throw std::invalid_argument("Empty pointer");
+    }
+    flush();
+    array_.insert(array_.end(), first, last);
+    isFlat_ = false;
+  }
 }
 #endif //A3_COMPOSITE_SHAPE_HPP
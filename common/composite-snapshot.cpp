@@ -0,0 +1,304 @@
+#include "composite-snapshot.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "batch-kernels.hpp"
+
+const size_t CHUNK_SIZE = 1024;
+
+golovin::CompositeSnapshot::CompositeSnapshot():
+  table_(std::make_shared<chunkTable>()),
+  size_(0)
+{}
+
+golovin::CompositeSnapshot::CompositeSnapshot(CompositeSnapshot &&src) noexcept:
+  table_(std::move(src.table_)),
+  size_(src.size_)
+{
+  src.size_ = 0;
+}
+
+golovin::CompositeSnapshot::CompositeSnapshot(const CompositeShape &composite):
+  CompositeSnapshot()
+{
+  for (size_t i = 0; i < composite.getSize(); ++i)
+  {
+    pushBack(composite[i]->clone());
+  }
+}
+
+golovin::CompositeSnapshot& golovin::CompositeSnapshot::operator=(CompositeSnapshot &&src) noexcept
+{
+  if (this != &src)
+  {
+    table_ = std::move(src.table_);
+    size_ = src.size_;
+    src.size_ = 0;
+  }
+  return *this;
+}
+
+const golovin::Shape& golovin::CompositeSnapshot::operator[](size_t index) const
+{
+  if (index >= size_)
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return *(*(*table_)[index / CHUNK_SIZE])[index % CHUNK_SIZE];
+}
+
+golovin::Shape& golovin::CompositeSnapshot::edit(size_t index)
+{
+  if (index >= size_)
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  shapePointer &shape = detach(index / CHUNK_SIZE)[index % CHUNK_SIZE];
+  if (shape.use_count() > 1)
+  {
+    shape = shape->clone();
+  }
+  return *shape;
+}
+
+void golovin::CompositeSnapshot::pushBack(const shapePointer &newElement)
+{
+  if (newElement == nullptr)
+  {
+    throw std::invalid_argument("Empty pointer");
+  }
+  pushBack(newElement->clone());
+}
+
+void golovin::CompositeSnapshot::pushBack(shapePointer &&newElement)
+{
+  if (newElement == nullptr)
+  {
+    throw std::invalid_argument("Empty pointer");
+  }
+  if (newElement.use_count() > 1)
+  {
+    newElement = newElement->clone();
+  }
+  if (!table_)
+  {
+    table_ = std::make_shared<chunkTable>();
+  }
+  if (size_ % CHUNK_SIZE == 0)
+  {
+    if (table_.use_count() > 1)
+    {
+      table_ = std::make_shared<chunkTable>(*table_);
+    }
+    std::shared_ptr<chunk_t> chunk = std::make_shared<chunk_t>();
+    chunk->reserve(CHUNK_SIZE);
+    table_->push_back(std::move(chunk));
+  }
+  detach(size_ / CHUNK_SIZE).push_back(std::move(newElement));
+  ++size_;
+}
+
+void golovin::CompositeSnapshot::popBack()
+{
+  if (size_ == 0)
+  {
+    throw std::logic_error("Array is empty");
+  }
+  --size_;
+  detach(size_ / CHUNK_SIZE).pop_back();
+  if (size_ % CHUNK_SIZE == 0)
+  {
+    table_->pop_back();
+  }
+}
+
+size_t golovin::CompositeSnapshot::getSize() const noexcept
+{
+  return size_;
+}
+
+bool golovin::CompositeSnapshot::isEmpty() const noexcept
+{
+  return size_ == 0;
+}
+
+double golovin::CompositeSnapshot::getArea() const
+{
+  double sum = 0.0;
+  if (size_ != 0)
+  {
+    for (const std::shared_ptr<chunk_t> &chunk : *table_)
+    {
+      for (const shapePointer &shape : *chunk)
+      {
+        sum += shape->getArea();
+      }
+    }
+  }
+  return sum;
+}
+
+golovin::rectangle_t golovin::CompositeSnapshot::getFrameRect() const
+{
+  rectangle_t frame{};
+  if (!tryGetFrameRect(frame))
+  {
+    if (size_ == 0)
+    {
+      throw std::logic_error("Array is empty");
+    }
+    for (const std::shared_ptr<chunk_t> &chunk : *table_)
+    {
+      for (const shapePointer &shape : *chunk)
+      {
+        shape->getFrameRect();
+      }
+    }
+    //Every child produced a frame after tryGetFrameRect() reported none; frame was never written.
+    throw std::logic_error("Frame is not available");
+  }
+  return frame;
+}
+
+bool golovin::CompositeSnapshot::tryGetFrameRect(rectangle_t &frame) const
+{
+  rectangle_t curr{};
+  if ((size_ == 0) || !(*this)[0].tryGetFrameRect(curr))
+  {
+    return false;
+  }
+  kernels::bounds_t bounds{curr.pos.x - curr.width / 2.0, curr.pos.x + curr.width / 2.0,
+      curr.pos.y - curr.height / 2.0, curr.pos.y + curr.height / 2.0};
+  for (const std::shared_ptr<chunk_t> &chunk : *table_)
+  {
+    for (const shapePointer &shape : *chunk)
+    {
+      if (!shape->tryGetFrameRect(curr))
+      {
+        return false;
+      }
+      bounds.minX = std::min(bounds.minX, curr.pos.x - curr.width / 2.0);
+      bounds.maxX = std::max(bounds.maxX, curr.pos.x + curr.width / 2.0);
+      bounds.minY = std::min(bounds.minY, curr.pos.y - curr.height / 2.0);
+      bounds.maxY = std::max(bounds.maxY, curr.pos.y + curr.height / 2.0);
+    }
+  }
+  frame = kernels::toRectangle(bounds);
+  return true;
+}
+
+void golovin::CompositeSnapshot::scale(double coefficient)
+{
+  if (coefficient <= 0.0)
+  {
+    throw std::invalid_argument("Scaling coefficient is not positive");
+  }
+  if (size_ == 0)
+  {
+    return;
+  }
+  const point_t pivot = getPos();
+  editAll([&pivot, coefficient](Shape &shape)
+  {
+    const point_t pos = shape.getPos();
+    shape.move((pivot.x - pos.x) * (1.0 - coefficient), (pivot.y - pos.y) * (1.0 - coefficient));
+    shape.scale(coefficient);
+  });
+}
+
+void golovin::CompositeSnapshot::move(const point_t &destinationPoint)
+{
+  const point_t center = getPos();
+  move(destinationPoint.x - center.x, destinationPoint.y - center.y);
+}
+
+void golovin::CompositeSnapshot::move(double dX, double dY)
+{
+  editAll([dX, dY](Shape &shape)
+  {
+    shape.move(dX, dY);
+  });
+}
+
+golovin::point_t golovin::CompositeSnapshot::getPos() const
+{
+  return getFrameRect().pos;
+}
+
+void golovin::CompositeSnapshot::rotate(double angle)
+{
+  const double PI_IN_DEGREES = 180.0;
+  const double angleRadian = angle * (M_PI / PI_IN_DEGREES);
+  const double sinAngle = std::sin(angleRadian);
+  const double cosAngle = std::cos(angleRadian);
+  const point_t pivot = getPos();
+  editAll([&pivot, angle, sinAngle, cosAngle](Shape &shape)
+  {
+    const point_t pos = shape.getPos();
+    const double dX = pos.x - pivot.x;
+    const double dY = pos.y - pivot.y;
+    shape.move(pivot.x + dX * cosAngle - dY * sinAngle - pos.x, pivot.y + dY * cosAngle + dX * sinAngle - pos.y);
+    shape.rotate(angle);
+  });
+}
+
+void golovin::CompositeSnapshot::print(std::ostream &out) const
+{
+  out << "CompositeSnapshot ";
+}
+
+std::shared_ptr<golovin::Shape> golovin::CompositeSnapshot::clone() const
+{
+  return std::make_shared<CompositeSnapshot>(*this);
+}
+
+bool golovin::CompositeSnapshot::contains(const point_t &point) const
+{
+  if (size_ != 0)
+  {
+    for (const std::shared_ptr<chunk_t> &chunk : *table_)
+    {
+      for (const shapePointer &shape : *chunk)
+      {
+        if (shape->contains(point))
+        {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+golovin::CompositeSnapshot::chunk_t& golovin::CompositeSnapshot::detach(size_t chunk)
+{
+  if (table_.use_count() > 1)
+  {
+    table_ = std::make_shared<chunkTable>(*table_);
+  }
+  std::shared_ptr<chunk_t> &current = (*table_)[chunk];
+  if (current.use_count() > 1)
+  {
+    std::shared_ptr<chunk_t> copy = std::make_shared<chunk_t>();
+    copy->reserve(CHUNK_SIZE);
+    copy->assign(current->begin(), current->end());
+    current = std::move(copy);
+  }
+  return *current;
+}
+
+template <typename Function>
+void golovin::CompositeSnapshot::editAll(Function function)
+{
+  for (size_t i = 0; i < size_; i += CHUNK_SIZE)
+  {
+    for (shapePointer &shape : detach(i / CHUNK_SIZE))
+    {
+      if (shape.use_count() > 1)
+      {
+        shape = shape->clone();
+      }
+      function(*shape);
+    }
+  }
+}
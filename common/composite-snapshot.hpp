@@ -0,0 +1,86 @@
+#ifndef A4_COMPOSITE_SNAPSHOT_HPP
+#define A4_COMPOSITE_SNAPSHOT_HPP
+
+#include <memory>
+#include <vector>
+#include "shape.hpp"
+#include "base-types.hpp"
+#include "composite-shape.hpp"
+
+namespace golovin
+{
+  class CompositeSnapshot : public Shape
+  {
+  public:
+    typedef std::shared_ptr<Shape> shapePointer;
+
+    CompositeSnapshot();
+
+    CompositeSnapshot(const CompositeSnapshot &) = default;
+
+    CompositeSnapshot(CompositeSnapshot &&) noexcept;
+
+    //Clones the composite's children once, since the composite changes them in place; copies of the
+    //snapshot then share them and cost O(1).
+    explicit CompositeSnapshot(const CompositeShape &);
+
+    ~CompositeSnapshot() override = default;
+
+    CompositeSnapshot& operator=(const CompositeSnapshot &) = default;
+
+    CompositeSnapshot& operator=(CompositeSnapshot &&) noexcept;
+
+    const Shape& operator[](size_t) const;
+
+    Shape& edit(size_t);
+
+    //Stores a clone, so a snapshot never shares a shape with an outside owner and changes made through
+    //the caller's pointer do not reach it. Only snapshots share shapes, and edit() separates them.
+    void pushBack(const shapePointer &);
+
+    //Takes the shape without cloning it when no other pointer owns it.
+    void pushBack(shapePointer &&);
+
+    void popBack();
+
+    size_t getSize() const noexcept;
+
+    bool isEmpty() const noexcept;
+
+    double getArea() const override;
+
+    rectangle_t getFrameRect() const override;
+
+    bool tryGetFrameRect(rectangle_t &) const override;
+
+    void scale(double) override;
+
+    void move(const point_t &) override;
+
+    void move(double dX, double dY) override;
+
+    point_t getPos() const override;
+
+    void rotate(double) override;
+
+    void print(std::ostream &) const override;
+
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const override;
+
+  private:
+    typedef std::vector<shapePointer> chunk_t;
+    typedef std::vector<std::shared_ptr<chunk_t>> chunkTable;
+
+    std::shared_ptr<chunkTable> table_;
+    size_t size_;
+
+    chunk_t& detach(size_t chunk);
+
+    template <typename Function>
+    void editAll(Function function);
+  };
+}
+
+#endif //A4_COMPOSITE_SNAPSHOT_HPP
@@ -0,0 +1,160 @@
+#include "concurrent-composite-shape.hpp"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+const size_t PRODUCER_BUFFER_SIZE = 1024;
+
+golovin::ConcurrentCompositeShape::Producer::Producer(ConcurrentCompositeShape &owner):
+  owner_(&owner),
+  shard_(owner.next_++ % owner.shardCount_)
+{
+  buffer_.reserve(PRODUCER_BUFFER_SIZE);
+}
+
+golovin::ConcurrentCompositeShape::Producer::Producer(Producer &&src) noexcept:
+  owner_(src.owner_),
+  shard_(src.shard_),
+  buffer_(std::move(src.buffer_))
+{
+  src.owner_ = nullptr;
+}
+
+golovin::ConcurrentCompositeShape::Producer::~Producer()
+{
+  if (owner_)
+  {
+    try
+    {
+      flush();
+    }
+    catch (...)
+    {}
+  }
+}
+
+void golovin::ConcurrentCompositeShape::Producer::pushBack(const shapePointer &newElement)
+{
+  pushBack(shapePointer(newElement));
+}
+
+void golovin::ConcurrentCompositeShape::Producer::pushBack(shapePointer &&newElement)
+{
+  if (newElement == nullptr)
+  {
+    throw std::invalid_argument("Empty pointer");
+  }
+  if (!owner_)
+  {
+    throw std::logic_error("Producer was moved from");
+  }
+  buffer_.push_back(std::move(newElement));
+  //A failed flush leaves the buffer full, so the next push tries again.
+  if (buffer_.size() >= PRODUCER_BUFFER_SIZE)
+  {
+    flush();
+  }
+}
+
+void golovin::ConcurrentCompositeShape::Producer::flush()
+{
+  if (!owner_)
+  {
+    throw std::logic_error("Producer was moved from");
+  }
+  if (!buffer_.empty())
+  {
+    owner_->append(buffer_, shard_);
+  }
+}
+
+golovin::ConcurrentCompositeShape::ConcurrentCompositeShape():
+  ConcurrentCompositeShape(std::max(1u, std::thread::hardware_concurrency()))
+{}
+
+golovin::ConcurrentCompositeShape::ConcurrentCompositeShape(size_t shards):
+  shardCount_(shards),
+  next_(0),
+  size_(0)
+{
+  if (shards == 0)
+  {
+    throw std::invalid_argument("Concurrent composite must have at least one shard");
+  }
+  shards_ = std::make_unique<shard_t[]>(shards);
+}
+
+void golovin::ConcurrentCompositeShape::pushBack(const shapePointer &newElement)
+{
+  pushBack(shapePointer(newElement));
+}
+
+void golovin::ConcurrentCompositeShape::pushBack(shapePointer &&newElement)
+{
+  if (newElement == nullptr)
+  {
+    throw std::invalid_argument("Empty pointer");
+  }
+  size_t index = 0;
+  const std::unique_lock<std::mutex> lock = lockShard(index);
+  shards_[index].shapes.push_back(std::move(newElement));
+  ++size_;
+}
+
+golovin::CompositeShape golovin::ConcurrentCompositeShape::seal()
+{
+  std::vector<std::unique_lock<std::mutex>> locks;
+  locks.reserve(shardCount_);
+  size_t count = 0;
+  for (size_t i = 0; i < shardCount_; ++i)
+  {
+    locks.emplace_back(shards_[i].mutex);
+    count += shards_[i].shapes.size();
+  }
+  CompositeShape composite;
+  composite.reserve(count);
+  for (size_t i = 0; i < shardCount_; ++i)
+  {
+    std::vector<shapePointer> &shapes = shards_[i].shapes;
+    composite.append(std::make_move_iterator(shapes.begin()), std::make_move_iterator(shapes.end()));
+    shapes.clear();
+  }
+  size_ -= count;
+  return composite;
+}
+
+size_t golovin::ConcurrentCompositeShape::getSize() const noexcept
+{
+  return size_;
+}
+
+size_t golovin::ConcurrentCompositeShape::getShardCount() const noexcept
+{
+  return shardCount_;
+}
+
+std::unique_lock<std::mutex> golovin::ConcurrentCompositeShape::lockShard(size_t &index)
+{
+  const size_t start = next_++ % shardCount_;
+  for (size_t i = 0; i < shardCount_; ++i)
+  {
+    index = (start + i) % shardCount_;
+    std::unique_lock<std::mutex> lock(shards_[index].mutex, std::try_to_lock);
+    if (lock.owns_lock())
+    {
+      return lock;
+    }
+  }
+  index = start;
+  return std::unique_lock<std::mutex>(shards_[index].mutex);
+}
+
+void golovin::ConcurrentCompositeShape::append(std::vector<shapePointer> &buffer, size_t shard)
+{
+  const std::lock_guard<std::mutex> lock(shards_[shard].mutex);
+  std::vector<shapePointer> &shapes = shards_[shard].shapes;
+  shapes.insert(shapes.end(), std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+  size_ += buffer.size();
+  buffer.clear();
+}
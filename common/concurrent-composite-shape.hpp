@@ -0,0 +1,85 @@
+#ifndef A4_CONCURRENT_COMPOSITE_SHAPE_HPP
+#define A4_CONCURRENT_COMPOSITE_SHAPE_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "shape.hpp"
+#include "composite-shape.hpp"
+
+namespace golovin
+{
+  class ConcurrentCompositeShape
+  {
+  public:
+    typedef std::shared_ptr<Shape> shapePointer;
+
+    //Buffers shapes for one thread and always flushes them into the same shard, so a producer's shapes
+    //keep their order in the sealed composite (interleaved with other producers' batches). Shapes pushed
+    //straight into the composite go to whichever shard is free and keep no order.
+    class Producer
+    {
+    public:
+      explicit Producer(ConcurrentCompositeShape &);
+
+      Producer(const Producer &) = delete;
+
+      Producer(Producer &&) noexcept;
+
+      //Flushes what is left but swallows any error; call flush() first to see it.
+      ~Producer();
+
+      Producer& operator=(const Producer &) = delete;
+
+      void pushBack(const shapePointer &);
+
+      void pushBack(shapePointer &&);
+
+      //On an exception the buffered shapes stay in the producer, so the call can be repeated. A moved-from
+      //producer has no owner, and flush() and pushBack() throw logic_error for it.
+      void flush();
+
+    private:
+      ConcurrentCompositeShape *owner_;
+      size_t shard_;
+      std::vector<shapePointer> buffer_;
+    };
+
+    ConcurrentCompositeShape();
+
+    explicit ConcurrentCompositeShape(size_t shards);
+
+    ConcurrentCompositeShape(const ConcurrentCompositeShape &) = delete;
+
+    ConcurrentCompositeShape& operator=(const ConcurrentCompositeShape &) = delete;
+
+    void pushBack(const shapePointer &);
+
+    void pushBack(shapePointer &&);
+
+    CompositeShape seal();
+
+    size_t getSize() const noexcept;
+
+    size_t getShardCount() const noexcept;
+
+  private:
+    struct shard_t
+    {
+      std::mutex mutex;
+      std::vector<shapePointer> shapes;
+    };
+
+    std::unique_ptr<shard_t[]> shards_;
+    size_t shardCount_;
+    std::atomic<size_t> next_;
+    std::atomic<size_t> size_;
+
+    std::unique_lock<std::mutex> lockShard(size_t &index);
+
+    void append(std::vector<shapePointer> &buffer, size_t shard);
+  };
+}
+
+#endif //A4_CONCURRENT_COMPOSITE_SHAPE_HPP
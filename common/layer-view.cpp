@@ -0,0 +1,51 @@
+#include "layer-view.hpp"
+#include <stdexcept>
+
+golovin::LayerView::LayerView() noexcept:
+  array_(nullptr),
+  size_(0)
+{}
+
+golovin::LayerView::LayerView(const shapePointer *array, size_t size) noexcept:
+  array_(array),
+  size_(array ? size : 0)
+{
+  while ((size_ > 0) && !array_[size_ - 1])
+  {
+    --size_;
+  }
+}
+
+const golovin::LayerView::shapePointer &golovin::LayerView::operator[](size_t index) const
+{
+  if (index >= size_)
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return getUnchecked(index);
+}
+
+const golovin::LayerView::shapePointer &golovin::LayerView::getUnchecked(size_t index) const noexcept
+{
+  return array_[index];
+}
+
+size_t golovin::LayerView::getSize() const noexcept
+{
+  return size_;
+}
+
+bool golovin::LayerView::isEmpty() const noexcept
+{
+  return (size_ == 0);
+}
+
+golovin::LayerView::iterator golovin::LayerView::begin() const noexcept
+{
+  return array_;
+}
+
+golovin::LayerView::iterator golovin::LayerView::end() const noexcept
+{
+  return array_ + size_;
+}
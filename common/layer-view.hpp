@@ -0,0 +1,37 @@
+#ifndef A4_LAYER_VIEW_HPP
+#define A4_LAYER_VIEW_HPP
+
+#include <memory>
+#include "shape.hpp"
+
+namespace golovin
+{
+  class LayerView
+  {
+  public:
+    typedef std::shared_ptr<Shape> shapePointer;
+    typedef const shapePointer *iterator;
+
+    LayerView() noexcept;
+
+    LayerView(const shapePointer *array, size_t size) noexcept;
+
+    const shapePointer& operator[](size_t index) const;
+
+    const shapePointer& getUnchecked(size_t index) const noexcept;
+
+    size_t getSize() const noexcept;
+
+    bool isEmpty() const noexcept;
+
+    iterator begin() const noexcept;
+
+    iterator end() const noexcept;
+
+  private:
+    const shapePointer *array_;
+    size_t size_;
+  };
+}
+
+#endif //A4_LAYER_VIEW_HPP
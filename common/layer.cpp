@@ -1,43 +1,33 @@
 #include "layer.hpp"
+#include <stdexcept>
 
 golovin::Layer::Layer(const Layer &src):
-  size_(src.size_),
-  array_(std::make_unique<shapePointer[]>(src.size_))
-{
-  for (size_t i = 0; i < src.size_; ++i)
-  {
-    array_[i] = src.array_[i];
-  }
-}
+  array_(src.array_)
+{}
 
 golovin::Layer::Layer(Layer &&src) noexcept:
-  size_(src.size_),
   array_(std::move(src.array_))
 {
-  src.size_ = 0;
+  src.array_.clear();
 }
 
 golovin::Layer::Layer(const shapeArray &array, size_t size):
-  size_(size),
-  array_(std::make_unique<shapePointer[]>(size_))
+  array_(array.get(), array.get() + size)
+{}
+
+golovin::Layer::Layer(const shapePointer *array, size_t count, size_t size, const allocator_type &allocator):
+  array_(allocator)
 {
-  for (size_t i = 0; i < size_; ++i)
-  {
-    array_[i] = array[i];
-  }
+  array_.reserve(size);
+  array_.assign(array, array + count);
+  array_.resize(size);
 }
 
 golovin::Layer &golovin::Layer::operator=(const Layer &src)
 {
   if (this != &src)
   {
-    size_ = src.size_;
-    shapeArray tmpArray(std::make_unique<shapePointer[]>(size_));
-    for (size_t i = 0; i < size_; ++i)
-    {
-      tmpArray[i] = src.array_[i];
-    }
-    array_.swap(tmpArray);
+    array_ = src.array_;
   }
   return *this;
 }
@@ -46,23 +36,27 @@ golovin::Layer &golovin::Layer::operator=(Layer &&src) noexcept
 {
   if (this != &src)
   {
-    size_ = src.size_;
     array_ = std::move(src.array_);
-    src.size_ = 0;
+    src.array_.clear();
   }
   return *this;
 }
 
 size_t golovin::Layer::getSize() const noexcept
 {
-  return size_;
+  return array_.size();
 }
 
 golovin::Layer::shapePointer golovin::Layer::operator[](size_t index) const
 {
-  if ((index >= size_) || (index < 0))
+  if (index >= array_.size())
   {
     throw std::out_of_range("Index is out of range");
   }
+  return getUnchecked(index);
+}
+
+const golovin::Layer::shapePointer &golovin::Layer::getUnchecked(size_t index) const noexcept
+{
   return array_[index];
 }
@@ -2,7 +2,9 @@
 #define A4_LAYER_HPP
 
 #include <memory>
+#include <vector>
 #include "shape.hpp"
+#include "arena.hpp"
 
 namespace golovin
 {
@@ -11,6 +13,7 @@ namespace golovin
   public:
     typedef std::shared_ptr<Shape> shapePointer;
     typedef std::unique_ptr<shapePointer[]> shapeArray;
+    typedef ArenaAllocator<shapePointer> allocator_type;
 
     Layer(const Layer &);
 
@@ -18,6 +21,8 @@ namespace golovin
 
     Layer(const shapeArray &array, size_t size);
 
+    Layer(const shapePointer *array, size_t count, size_t size, const allocator_type &);
+
     ~Layer() = default;
 
     Layer& operator=(const Layer &);
@@ -26,11 +31,12 @@ namespace golovin
 
     shapePointer operator[](size_t index) const;
 
+    const shapePointer& getUnchecked(size_t index) const noexcept;
+
     size_t getSize() const noexcept;
 
   private:
-    size_t size_;
-    shapeArray array_;
+    std::vector<shapePointer, allocator_type> array_;
   };
 }
 
@@ -1,59 +1,84 @@
 #include "matrix.hpp"
 #include <cmath>
+#include <algorithm>
+#include <functional>
 
 golovin::MatrixShape::MatrixShape():
-  rows_(1),
+  MatrixShape(allocator_type())
+{}
+
+golovin::MatrixShape::MatrixShape(const allocator_type &allocator):
   cols_(1),
-  array_(std::make_unique<shapePointer[]>(1))
-{
-  array_[0] = nullptr;
-}
+  layers_(1, shapeVector(allocator), allocator),
+  frames_(1, frameVector(allocator), allocator),
+  isTracked_(false)
+{}
 
 golovin::MatrixShape::MatrixShape(const MatrixShape &src):
-  rows_(src.rows_),
   cols_(src.cols_),
-  array_(std::make_unique<shapePointer[]>(cols_ * rows_))
-{
-  for (size_t i = 0; i < cols_ * rows_; ++i)
-  {
-    array_[i] = src.array_[i];
-  }
-}
+  layers_(src.layers_),
+  frames_(src.frames_),
+  index_(src.index_ ? std::make_unique<SpatialGrid>(*src.index_) : nullptr),
+  isTracked_(src.isTracked_),
+  entries_(src.entries_),
+  slots_(src.slots_),
+  ids_(src.ids_),
+  changed_(src.changed_)
+{}
 
 golovin::MatrixShape::MatrixShape(MatrixShape &&src) noexcept:
-  rows_(src.rows_),
   cols_(src.cols_),
-  array_(std::move(src.array_))
+  layers_(std::move(src.layers_)),
+  frames_(std::move(src.frames_)),
+  index_(std::move(src.index_)),
+  isTracked_(src.isTracked_),
+  entries_(std::move(src.entries_)),
+  slots_(std::move(src.slots_)),
+  ids_(std::move(src.ids_)),
+  changed_(std::move(src.changed_))
 {
-  src.rows_ = 0;
   src.cols_ = 0;
+  src.disableIndex();
+  src.layers_.clear();
+  src.frames_.clear();
 }
 
 golovin::MatrixShape::MatrixShape(const CompositeShape &cShape):
   MatrixShape()
 {
-  if (cShape.isEmpty())
-  {
-    throw std::invalid_argument("Composite shape must be not empty");
-  }
-  for (size_t i = 0; i < cShape.getSize(); ++i)
-  {
-    addShape(cShape[i]);
-  }
+  build(cShape, nullptr, nullptr);
+}
+
+golovin::MatrixShape::MatrixShape(const CompositeShape &cShape, double cellSize):
+  MatrixShape(cShape)
+{
+  enableIndex(cellSize);
+}
+
+golovin::MatrixShape::MatrixShape(const CompositeShape &cShape, ThreadPool &pool):
+  MatrixShape()
+{
+  build(cShape, &pool, nullptr);
+}
+
+golovin::MatrixShape::MatrixShape(const CompositeShape &cShape, const allocator_type &allocator):
+  MatrixShape(allocator)
+{
+  build(cShape, nullptr, nullptr);
+}
+
+golovin::MatrixShape::MatrixShape(const CompositeShape &cShape, const std::vector<size_t> &rows,
+    const allocator_type &allocator):
+  MatrixShape(allocator)
+{
+  build(cShape, nullptr, &rows);
 }
 
 golovin::MatrixShape &golovin::MatrixShape::operator=(const MatrixShape &src)
 {
   if (this != &src)
   {
-    shapeArray tmpArray = std::make_unique<shapePointer[]>(rows_ * cols_);
-    rows_ = src.rows_;
-    cols_= src.cols_;
-    for (size_t i = 0; i < (rows_ * cols_); ++i)
-    {
-      tmpArray[i] = src.array_[i];
-    }
-    array_.swap(tmpArray);
+    *this = MatrixShape(src);
   }
   return *this;
 }
@@ -62,11 +87,19 @@ golovin::MatrixShape &golovin::MatrixShape::operator=(MatrixShape &&src) noexcep
 {
   if (this != &src)
   {
-    rows_ = src.rows_;
     cols_ = src.cols_;
-    array_ = std::move(src.array_);
-    src.rows_ = 0;
+    layers_ = std::move(src.layers_);
+    frames_ = std::move(src.frames_);
+    index_ = std::move(src.index_);
+    isTracked_ = src.isTracked_;
+    entries_ = std::move(src.entries_);
+    slots_ = std::move(src.slots_);
+    ids_ = std::move(src.ids_);
+    changed_ = std::move(src.changed_);
     src.cols_ = 0;
+    src.disableIndex();
+    src.layers_.clear();
+    src.frames_.clear();
   }
   return *this;
 }
@@ -77,105 +110,398 @@ void golovin::MatrixShape::addShape(const shapePointer &shape)
   {
     throw std::invalid_argument("Null pointer received");
   }
-  size_t currRow = 0;
-  bool isPlace = false;
-  for (size_t i = 0; i < rows_; ++i)
+  if (!isTracked_)
+  {
+    const rectangle_t frame = shape->getFrameRect();
+    place(shape, frame, findRow(frame));
+    return;
+  }
+  entries_.push_back({shape, 0, 0});
+  ids_.emplace(shape.get(), entries_.size() - 1);
+  insertEntry(entries_.size() - 1);
+}
+
+void golovin::MatrixShape::enableIndex(double cellSize)
+{
+  std::unique_ptr<SpatialGrid> tmpIndex = std::make_unique<SpatialGrid>(cellSize);
+  if (!isTracked_)
   {
-    if (isPlace)
+    track();
+  }
+  for (size_t i = 0; i < slots_.size(); ++i)
+  {
+    for (size_t j = 0; j < slots_[i].size(); ++j)
     {
-      break;
+      tmpIndex->insert(slots_[i][j], frames_[i][j]);
     }
-    for (size_t j = 0; (j < cols_); ++j)
+  }
+  index_.swap(tmpIndex);
+}
+
+void golovin::MatrixShape::track()
+{
+  std::vector<entry_t> tmpEntries;
+  std::vector<idVector> tmpSlots(layers_.size());
+  std::unordered_multimap<const Shape *, size_t> tmpIds;
+  for (size_t i = 0; i < layers_.size(); ++i)
+  {
+    for (size_t j = 0; j < layers_[i].size(); ++j)
     {
-      if (array_[i * cols_ + j] == nullptr)
-      {
-        isPlace = true;
-        break;
-      }
-      if (isOverlapped(array_[i * cols_ + j], shape))
+      tmpSlots[i].push_back(tmpEntries.size());
+      tmpIds.emplace(layers_[i][j].get(), tmpEntries.size());
+      tmpEntries.push_back({layers_[i][j], i, j});
+    }
+  }
+  entries_.swap(tmpEntries);
+  slots_.swap(tmpSlots);
+  ids_.swap(tmpIds);
+  changed_.clear();
+  isTracked_ = true;
+}
+
+void golovin::MatrixShape::disableIndex() noexcept
+{
+  index_.reset();
+  isTracked_ = false;
+  entries_.clear();
+  slots_.clear();
+  ids_.clear();
+  changed_.clear();
+}
+
+bool golovin::MatrixShape::isIndexed() const noexcept
+{
+  return index_ != nullptr;
+}
+
+void golovin::MatrixShape::markChanged(const shapePointer &shape)
+{
+  if (!isTracked_)
+  {
+    track();
+  }
+  typedef std::unordered_multimap<const Shape *, size_t>::const_iterator idIterator;
+  const std::pair<idIterator, idIterator> range = ids_.equal_range(shape.get());
+  if (range.first == range.second)
+  {
+    throw std::invalid_argument("Shape is not in the matrix");
+  }
+  for (idIterator i = range.first; i != range.second; ++i)
+  {
+    changed_.push_back(i->second);
+  }
+}
+
+void golovin::MatrixShape::update()
+{
+  if (changed_.empty())
+  {
+    return;
+  }
+  std::sort(changed_.begin(), changed_.end());
+  changed_.erase(std::unique(changed_.begin(), changed_.end()), changed_.end());
+  for (size_t id : changed_)
+  {
+    removeEntry(id);
+  }
+  for (size_t id : changed_)
+  {
+    insertEntry(id);
+  }
+  changed_.clear();
+  compact();
+  cols_ = 1;
+  for (const shapeVector &layer : layers_)
+  {
+    cols_ = std::max(cols_, layer.size());
+  }
+}
+
+size_t golovin::MatrixShape::findRow(const rectangle_t &frame) const
+{
+  for (size_t i = 0; i < frames_.size(); ++i)
+  {
+    if (!isOverlapped(frames_[i].data(), frames_[i].size(), frame))
+    {
+      return i;
+    }
+  }
+  return frames_.size();
+}
+
+size_t golovin::MatrixShape::findRowIndexed(const rectangle_t &frame)
+{
+  index_->query(frame, candidates_);
+  busyRows_.clear();
+  for (size_t id : candidates_)
+  {
+    if (SweepAndPrune::isOverlapped(frames_[entries_[id].row][entries_[id].col], frame))
+    {
+      busyRows_.push_back(entries_[id].row);
+    }
+  }
+  std::sort(busyRows_.begin(), busyRows_.end());
+  busyRows_.erase(std::unique(busyRows_.begin(), busyRows_.end()), busyRows_.end());
+  size_t row = 0;
+  while ((row < busyRows_.size()) && (busyRows_[row] == row))
+  {
+    ++row;
+  }
+  return row;
+}
+
+size_t golovin::MatrixShape::place(const shapePointer &shape, const rectangle_t &frame, size_t row)
+{
+  if (row == layers_.size())
+  {
+    layers_.emplace_back(layers_.get_allocator());
+    frames_.emplace_back(frames_.get_allocator());
+    if (isTracked_)
+    {
+      slots_.emplace_back();
+    }
+  }
+  layers_[row].push_back(shape);
+  frames_[row].push_back(frame);
+  cols_ = std::max(cols_, layers_[row].size());
+  return layers_[row].size() - 1;
+}
+
+void golovin::MatrixShape::insertEntry(size_t id)
+{
+  entry_t &entry = entries_[id];
+  const rectangle_t frame = entry.shape->getFrameRect();
+  entry.row = index_ ? findRowIndexed(frame) : findRow(frame);
+  entry.col = place(entry.shape, frame, entry.row);
+  slots_[entry.row].push_back(id);
+  if (index_)
+  {
+    index_->insert(id, frame);
+  }
+}
+
+void golovin::MatrixShape::removeEntry(size_t id)
+{
+  const entry_t &entry = entries_[id];
+  shapeVector &layer = layers_[entry.row];
+  frameVector &frames = frames_[entry.row];
+  idVector &slots = slots_[entry.row];
+  if (index_)
+  {
+    index_->remove(id, frames[entry.col]);
+  }
+  if (entry.col != layer.size() - 1)
+  {
+    layer[entry.col] = std::move(layer.back());
+    frames[entry.col] = frames.back();
+    slots[entry.col] = slots.back();
+    entries_[slots.back()].col = entry.col;
+  }
+  layer.pop_back();
+  frames.pop_back();
+  slots.pop_back();
+}
+
+void golovin::MatrixShape::compact()
+{
+  size_t kept = 0;
+  for (size_t i = 0; i < layers_.size(); ++i)
+  {
+    if (layers_[i].empty())
+    {
+      continue;
+    }
+    if (kept != i)
+    {
+      layers_[kept].swap(layers_[i]);
+      frames_[kept].swap(frames_[i]);
+      slots_[kept].swap(slots_[i]);
+      for (size_t id : slots_[kept])
       {
-        ++currRow;
-        break;
+        entries_[id].row = kept;
       }
     }
+    ++kept;
   }
-  if (currRow == rows_)
+  kept = std::max<size_t>(kept, 1);
+  layers_.erase(layers_.begin() + kept, layers_.end());
+  frames_.erase(frames_.begin() + kept, frames_.end());
+  slots_.erase(slots_.begin() + kept, slots_.end());
+}
+
+void golovin::MatrixShape::build(const CompositeShape &cShape, ThreadPool *pool, const std::vector<size_t> *rows)
+{
+  if (cShape.isEmpty())
   {
-    shapeArray tmpArray = std::make_unique<shapePointer[]>(cols_ * (++rows_));
-    for (size_t i = 0; i < (rows_ - 1) * cols_; ++i)
+    throw std::invalid_argument("Composite shape must be not empty");
+  }
+  const size_t count = cShape.getSize();
+  if (rows && (rows->size() != count))
+  {
+    throw std::invalid_argument("Every shape must have a row");
+  }
+  if (rows)
+  {
+    std::vector<char> isUsed(count, 0);
+    for (size_t row : *rows)
+    {
+      if (row >= count)
+      {
+        throw std::invalid_argument("Rows must not skip a layer");
+      }
+      isUsed[row] = 1;
+    }
+    //Any used layer after an unused one means a gap.
+    if (!std::is_sorted(isUsed.begin(), isUsed.end(), std::greater<char>()))
     {
-      tmpArray[i] = array_[i];
+      throw std::invalid_argument("Rows must not skip a layer");
     }
-    for (size_t i = 0; i < cols_; ++i)
+  }
+  cShape.flushTree();
+  const size_t tasks = pool ? pool->getThreadCount() : 1;
+  std::vector<rectangle_t> frames(count);
+  const ThreadPool::task_t readFrames = [&cShape, &frames, count, tasks](size_t task)
+  {
+    for (size_t i = count * task / tasks; i < count * (task + 1) / tasks; ++i)
     {
-      tmpArray[(rows_ - 1) * cols_ + i] = nullptr;
+      const shapePointer &shape = cShape.getUnchecked(i);
+      if (!shape)
+      {
+        throw std::invalid_argument("Null pointer received");
+      }
+      frames[i] = shape->getFrameRect();
     }
-    array_.swap(tmpArray);
+  };
+  if (pool)
+  {
+    pool->run(tasks, readFrames);
+  }
+  else
+  {
+    readFrames(0);
   }
-  for (size_t i = 0; i < cols_; ++i)
+  SweepAndPrune sweep;
+  std::vector<SweepAndPrune::pair_t> pairs;
+  sweep.update(frames, pairs, pool);
+  if (!rows)
   {
-    if (!array_[currRow * cols_ + i])
+    const std::vector<size_t> assigned = assignRows(count, pairs);
+    for (size_t i = 0; i < count; ++i)
     {
-      array_[currRow * cols_ + i] = shape;
-      return;
+      place(cShape.getUnchecked(i), frames[i], assigned[i]);
     }
+    return;
   }
-  shapeArray tmpArray = std::make_unique<shapePointer[]>((++cols_) * rows_);
-  for (size_t i = 0; i < rows_; ++i)
+  for (const SweepAndPrune::pair_t &pair : pairs)
   {
-    for (size_t j = 0; j < (cols_ - 1); ++j)
+    if ((*rows)[pair.first] == (*rows)[pair.second])
     {
-      tmpArray[i * cols_ + j] = array_[i * cols_ + j];
+      throw std::invalid_argument("Overlapping shapes share a row");
     }
-    tmpArray[i * cols_ + (cols_ - 1)] = nullptr;
   }
-  array_.swap(tmpArray);
-  array_[currRow * cols_ + (cols_ - 1)] = shape;
+  const size_t rowCount = *std::max_element(rows->begin(), rows->end()) + 1;
+  layers_.resize(rowCount, shapeVector(layers_.get_allocator()));
+  frames_.resize(rowCount, frameVector(frames_.get_allocator()));
+  for (size_t i = 0; i < count; ++i)
+  {
+    place(cShape.getUnchecked(i), frames[i], (*rows)[i]);
+  }
 }
 
-bool golovin::MatrixShape::isOverlapped(const shapePointer &first, const shapePointer &second)
+std::vector<size_t> golovin::MatrixShape::assignRows(size_t count, const std::vector<SweepAndPrune::pair_t> &pairs)
 {
-  if (!first || !second)
+  std::vector<size_t> offsets(count + 1, 0);
+  for (const SweepAndPrune::pair_t &pair : pairs)
   {
-    return false;
+    ++offsets[pair.second + 1];
   }
-  else
+  for (size_t i = 0; i < count; ++i)
+  {
+    offsets[i + 1] += offsets[i];
+  }
+  std::vector<size_t> earlier(offsets[count]);
+  std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+  for (const SweepAndPrune::pair_t &pair : pairs)
   {
-    const double distanceX = std::fabs(first->getFrameRect().pos.x - second->getFrameRect().pos.x);
-    const double distanceY = std::fabs(first->getFrameRect().pos.y - second->getFrameRect().pos.y);
-    const double sumWidth = ((first->getFrameRect().width + second->getFrameRect().width) / 2);
-    const double sumHeight = ((first->getFrameRect().height + second->getFrameRect().height) / 2);
-    return (distanceX < sumWidth) && (distanceY < sumHeight);
+    earlier[filled[pair.second]++] = pair.first;
   }
+  std::vector<size_t> rows(count);
+  std::vector<size_t> marks;
+  for (size_t i = 0; i < count; ++i)
+  {
+    for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+    {
+      marks[rows[earlier[j]]] = i + 1;
+    }
+    size_t row = 0;
+    while ((row < marks.size()) && (marks[row] == i + 1))
+    {
+      ++row;
+    }
+    if (row == marks.size())
+    {
+      marks.push_back(0);
+    }
+    rows[i] = row;
+  }
+  return rows;
+}
 
+bool golovin::MatrixShape::isOverlapped(const rectangle_t *frames, size_t count, const rectangle_t &frame) noexcept
+{
+  const size_t BLOCK_SIZE = 16;
+  for (size_t begin = 0; begin < count; begin += BLOCK_SIZE)
+  {
+    const size_t end = std::min(count, begin + BLOCK_SIZE);
+    bool isFound = false;
+    for (size_t i = begin; i < end; ++i)
+    {
+      isFound |= SweepAndPrune::isOverlapped(frames[i], frame);
+    }
+    if (isFound)
+    {
+      return true;
+    }
+  }
+  return false;
 }
 
-golovin::Layer golovin::MatrixShape::operator[](const size_t index) const
+golovin::LayerView golovin::MatrixShape::operator[](const size_t index) const
 {
-  if ((index >= rows_) || (index < 0))
+  if (index >= layers_.size())
   {
     throw std::out_of_range("Index is out of range");
   }
-  shapeArray tmpArray(std::make_unique<shapePointer[]>(cols_));
-  for (size_t i = 0; i < cols_; ++i)
+  return getUnchecked(index);
+}
+
+golovin::LayerView golovin::MatrixShape::getUnchecked(const size_t index) const noexcept
+{
+  return LayerView(layers_[index].data(), layers_[index].size());
+}
+
+golovin::Layer golovin::MatrixShape::getLayer(const size_t index) const
+{
+  if (index >= layers_.size())
   {
-    tmpArray[i] = array_[index * cols_ + i];
+    throw std::out_of_range("Index is out of range");
   }
-  return Layer(tmpArray, cols_);
+  return Layer(layers_[index].data(), layers_[index].size(), cols_, getAllocator());
+}
+
+size_t golovin::MatrixShape::getLayerCount() const noexcept
+{
+  return layers_.size();
 }
 
 void golovin::MatrixShape::print(std::ostream &out) const
 {
-  for (size_t i = 0; i < rows_; ++i)
+  for (size_t i = 0; i < layers_.size(); ++i)
   {
-    out << "Layer " + std::to_string(i) + " : ";
-    for (size_t j = 0; j < cols_; ++j)
+    out << "Layer " << i << " : ";
+    for (const shapePointer &shape : layers_[i])
     {
-      if (!array_[i * cols_ + j])
-      {
-        break;
-      }
-      array_[i * cols_ + j]->print(out);
+      shape->print(out);
     }
     out << "\n";
   }
@@ -183,5 +509,10 @@ void golovin::MatrixShape::print(std::ostream &out) const
 
 size_t golovin::MatrixShape::getSize() const
 {
-  return rows_ * cols_;
+  return layers_.size() * cols_;
+}
+
+golovin::MatrixShape::allocator_type golovin::MatrixShape::getAllocator() const noexcept
+{
+  return layers_.get_allocator();
 }
@@ -2,9 +2,16 @@
 #define A4_MATRIX_HPP
 
 #include <ostream>
+#include <vector>
+#include <unordered_map>
 #include "shape.hpp"
 #include "layer.hpp"
+#include "layer-view.hpp"
 #include "composite-shape.hpp"
+#include "spatial-grid.hpp"
+#include "thread-pool.hpp"
+#include "arena.hpp"
+#include "sweep-and-prune.hpp"
 
 namespace golovin
 {
@@ -12,35 +19,109 @@ namespace golovin
   {
   public:
     typedef std::shared_ptr<Shape> shapePointer;
-    typedef std::unique_ptr<shapePointer[]> shapeArray;
+    typedef ArenaAllocator<shapePointer> allocator_type;
 
     MatrixShape();
 
+    explicit MatrixShape(const allocator_type &);
+
     MatrixShape(const MatrixShape &);
 
     MatrixShape(MatrixShape &&) noexcept;
 
     explicit MatrixShape(const CompositeShape &);
 
+    MatrixShape(const CompositeShape &, double cellSize);
+
+    MatrixShape(const CompositeShape &, ThreadPool &);
+
+    MatrixShape(const CompositeShape &, const allocator_type &);
+
+    //Puts shape i into layer rows[i]. The rows must use every layer from 0 to the largest one, and
+    //overlapping shapes must not share a layer.
+    MatrixShape(const CompositeShape &, const std::vector<size_t> &rows,
+        const allocator_type &allocator = allocator_type());
+
     ~MatrixShape() = default;
 
     MatrixShape& operator=(const MatrixShape &);
 
     MatrixShape& operator=(MatrixShape &&) noexcept;
 
-    Layer operator[](size_t index) const;
+    LayerView operator[](size_t index) const;
+
+    LayerView getUnchecked(size_t index) const noexcept;
+
+    Layer getLayer(size_t index) const;
+
+    size_t getLayerCount() const noexcept;
 
     void addShape(const shapePointer &);
 
     void print( std::ostream &) const;
 
     size_t getSize() const;
+
+    //Shapes already marked by markChanged() stay marked for the next update().
+    void enableIndex(double cellSize);
+
+    void disableIndex() noexcept;
+
+    bool isIndexed() const noexcept;
+
+    //Without the spatial index the first call records where every shape is, and update() re-layers
+    //the marked shapes with a linear first-fit scan.
+    void markChanged(const shapePointer &);
+
+    //Re-layers the marked shapes first-fit in the order they were added and drops the layers left empty.
+    //Unmarked shapes keep their layer, so the rows may differ from a fresh build; the order of shapes
+    //within a layer is unspecified after an update.
+    void update();
+
+    allocator_type getAllocator() const noexcept;
   private:
-    size_t rows_;
+    struct entry_t
+    {
+      shapePointer shape;
+      size_t row;
+      size_t col;
+    };
+
+    typedef std::vector<shapePointer, allocator_type> shapeVector;
+    typedef std::vector<rectangle_t, ArenaAllocator<rectangle_t>> frameVector;
+    typedef std::vector<size_t> idVector;
+
     size_t cols_;
-    shapeArray array_;
+    std::vector<shapeVector, ArenaAllocator<shapeVector>> layers_;
+    std::vector<frameVector, ArenaAllocator<frameVector>> frames_;
+    std::unique_ptr<SpatialGrid> index_;
+    bool isTracked_;
+    std::vector<entry_t> entries_;
+    std::vector<idVector> slots_;
+    std::unordered_multimap<const Shape *, size_t> ids_;
+    idVector changed_;
+    idVector candidates_;
+    idVector busyRows_;
+
+    size_t findRow(const rectangle_t &) const;
+
+    size_t findRowIndexed(const rectangle_t &);
+
+    size_t place(const shapePointer &, const rectangle_t &, size_t row);
+
+    void track();
+
+    void insertEntry(size_t id);
+
+    void removeEntry(size_t id);
+
+    void compact();
+
+    void build(const CompositeShape &, ThreadPool *, const std::vector<size_t> *rows);
+
+    static std::vector<size_t> assignRows(size_t count, const std::vector<SweepAndPrune::pair_t> &pairs);
 
-    static bool isOverlapped(const shapePointer &first, const shapePointer &second);
+    static bool isOverlapped(const rectangle_t *frames, size_t count, const rectangle_t &frame) noexcept;
   };
 }
 
@@ -7,23 +7,24 @@ const double ACCURACY = 1e-8;
 
 golovin::Polygon::Polygon(const Polygon &src):
   size_(src.size_),
-  array_(std::make_unique<point_t[]>(src.size_))
-{
-  for (size_t i = 0; i < src.size_; ++i)
-  {
-    array_[i] = src.array_[i];
-  }
-}
+  array_(src.array_)
+{}
 
 golovin::Polygon::Polygon(Polygon &&src) noexcept:
   size_(src.size_),
   array_(std::move(src.array_))
 {
+  src.array_.clear();
   src.size_ = 0;
 }
 
 golovin::Polygon::Polygon(const point_t array[], const size_t size):
-  size_(size)
+  Polygon(array, size, allocator_type())
+{}
+
+golovin::Polygon::Polygon(const point_t array[], size_t size, const allocator_type &allocator):
+  size_(size),
+  array_(allocator)
 {
   if (size_ < 3)
   {
@@ -33,11 +34,7 @@ golovin::Polygon::Polygon(const point_t array[], const size_t size):
   {
     throw std::invalid_argument("Null pointer received");
   }
-  array_ = std::make_unique<golovin::point_t[]>(size_);
-  for (size_t i = 0; i < size_; ++i)
-  {
-    array_[i] = array[i];
-  }
+  array_.assign(array, array + size_);
   if (getArea() < ACCURACY)
   {
     throw std::invalid_argument("The shape must have an area");
@@ -70,12 +67,7 @@ golovin::Polygon &golovin::Polygon::operator=(const Polygon &src)
   if (this != &src)
   {
     size_ = src.size_;
-    std::unique_ptr<point_t[]> tmpArray(std::make_unique<golovin::point_t[]>(size_));
-    for (size_t i = 0; i < size_; ++i)
-    {
-      tmpArray[i] = src.array_[i];
-    }
-    array_.swap(tmpArray);
+    array_ = src.array_;
   }
   return *this;
 }
@@ -86,6 +78,7 @@ golovin::Polygon &golovin::Polygon::operator=(Polygon &&src) noexcept
   {
     size_ = src.size_;
     array_ = std::move(src.array_);
+    src.array_.clear();
     src.size_ = 0;
   }
   return *this;
@@ -178,3 +171,37 @@ void golovin::Polygon::print(std::ostream &out) const
 {
   out << "CompositeShape ";
 }
+
+std::shared_ptr<golovin::Shape> golovin::Polygon::clone() const
+{
+  return std::make_shared<Polygon>(*this);
+}
+
+bool golovin::Polygon::contains(const point_t &point) const noexcept
+{
+  bool hasNegative = false;
+  bool hasPositive = false;
+  for (size_t i = 0; i < size_; ++i)
+  {
+    const point_t &begin = array_[i];
+    const point_t &end = array_[(i + 1) % size_];
+    const double composition = (end.x - begin.x) * (point.y - begin.y) - (end.y - begin.y) * (point.x - begin.x);
+    hasNegative |= (composition < 0.0);
+    hasPositive |= (composition > 0.0);
+  }
+  return !(hasNegative && hasPositive);
+}
+
+size_t golovin::Polygon::getVertexCount() const noexcept
+{
+  return size_;
+}
+
+golovin::point_t golovin::Polygon::getVertex(size_t index) const
+{
+  if (index >= size_)
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return array_[index];
+}
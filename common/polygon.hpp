@@ -1,14 +1,16 @@
 #ifndef A4_POLYGON_HPP
 #define A4_POLYGON_HPP
-#include <memory>
+#include <vector>
 #include "shape.hpp"
 #include "base-types.hpp"
+#include "arena.hpp"
 
 namespace golovin
 {
   class Polygon : public Shape
   {
   public:
+    typedef ArenaAllocator<point_t> allocator_type;
 
     Polygon(const Polygon &);
 
@@ -16,6 +18,8 @@ namespace golovin
 
     Polygon(const point_t array[], size_t size);
 
+    Polygon(const point_t array[], size_t size, const allocator_type &);
+
     ~Polygon() = default;
 
     Polygon& operator=(const Polygon &);
@@ -37,9 +41,17 @@ namespace golovin
     void rotate(double) noexcept override;
 
     void print(std::ostream &) const override;
+
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const noexcept override;
+
+    size_t getVertexCount() const noexcept;
+
+    point_t getVertex(size_t index) const;
   private:
-    std::unique_ptr<point_t[]> array_;
     size_t size_;
+    std::vector<point_t, allocator_type> array_;
   };
 }
 
@@ -0,0 +1,161 @@
+#include "rectangle-batch.hpp"
+#include <cmath>
+#include <stdexcept>
+#include "batch-kernels.hpp"
+
+golovin::RectangleBatch::RectangleBatch() noexcept:
+  unnormalizedRotations_(0)
+{}
+
+void golovin::RectangleBatch::pushBack(const point_t &center, double width, double height)
+{
+  if ((width <= 0.0) || (height <= 0.0))
+  {
+    throw std::invalid_argument("The incoming sides of the rectangle must be > 0");
+  }
+  xs_.push_back(center.x);
+  ys_.push_back(center.y);
+  widths_.push_back(width);
+  heights_.push_back(height);
+  cosines_.push_back(1.0);
+  sines_.push_back(0.0);
+}
+
+void golovin::RectangleBatch::reserve(size_t capacity)
+{
+  xs_.reserve(capacity);
+  ys_.reserve(capacity);
+  widths_.reserve(capacity);
+  heights_.reserve(capacity);
+  cosines_.reserve(capacity);
+  sines_.reserve(capacity);
+}
+
+golovin::Rectangle golovin::RectangleBatch::operator[](size_t index) const
+{
+  if (index >= widths_.size())
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  const double PI_IN_DEGREES = 180.0;
+  Rectangle rectangle({xs_[index], ys_[index]}, widths_[index], heights_[index]);
+  rectangle.rotate(std::atan2(sines_[index], cosines_[index]) * (PI_IN_DEGREES / M_PI));
+  return rectangle;
+}
+
+size_t golovin::RectangleBatch::getSize() const noexcept
+{
+  return widths_.size();
+}
+
+bool golovin::RectangleBatch::isEmpty() const noexcept
+{
+  return widths_.empty();
+}
+
+double golovin::RectangleBatch::getArea() const noexcept
+{
+  return kernels::sumOfProducts(widths_.data(), heights_.data(), widths_.size());
+}
+
+golovin::rectangle_t golovin::RectangleBatch::getFrameRect() const
+{
+  rectangle_t frame{};
+  if (!tryGetFrameRect(frame))
+  {
+    throw std::logic_error("Array is empty");
+  }
+  return frame;
+}
+
+bool golovin::RectangleBatch::tryGetFrameRect(rectangle_t &frame) const noexcept
+{
+  if (widths_.empty())
+  {
+    return false;
+  }
+  frame = kernels::toRectangle(kernels::getRotatedBounds(xs_.data(), ys_.data(), widths_.data(), heights_.data(),
+      cosines_.data(), sines_.data(), widths_.size()));
+  return true;
+}
+
+void golovin::RectangleBatch::scale(double coefficient)
+{
+  if (coefficient <= 0.0)
+  {
+    throw std::invalid_argument("Scaling coefficient is not positive");
+  }
+  if (widths_.empty())
+  {
+    return;
+  }
+  const point_t center = getPos();
+  kernels::scaleAbout(xs_.data(), xs_.size(), center.x, coefficient);
+  kernels::scaleAbout(ys_.data(), ys_.size(), center.y, coefficient);
+  kernels::multiply(widths_.data(), widths_.size(), coefficient);
+  kernels::multiply(heights_.data(), heights_.size(), coefficient);
+}
+
+void golovin::RectangleBatch::move(const point_t &destinationPoint)
+{
+  if (widths_.empty())
+  {
+    return;
+  }
+  const point_t center = getPos();
+  move(destinationPoint.x - center.x, destinationPoint.y - center.y);
+}
+
+void golovin::RectangleBatch::move(double dX, double dY) noexcept
+{
+  kernels::shift(xs_.data(), xs_.size(), dX);
+  kernels::shift(ys_.data(), ys_.size(), dY);
+}
+
+golovin::point_t golovin::RectangleBatch::getPos() const
+{
+  return getFrameRect().pos;
+}
+
+void golovin::RectangleBatch::rotate(double angle)
+{
+  const size_t NORMALIZE_PERIOD = 64;
+  const double PI_IN_DEGREES = 180.0;
+  if (widths_.empty())
+  {
+    return;
+  }
+  const double angleRadian = angle * (M_PI / PI_IN_DEGREES);
+  const double cosAngle = std::cos(angleRadian);
+  const double sinAngle = std::sin(angleRadian);
+  kernels::rotateAbout(xs_.data(), ys_.data(), xs_.size(), getPos(), cosAngle, sinAngle);
+  kernels::rotateAbout(cosines_.data(), sines_.data(), cosines_.size(), {0.0, 0.0}, cosAngle, sinAngle);
+  if (++unnormalizedRotations_ == NORMALIZE_PERIOD)
+  {
+    kernels::normalize(cosines_.data(), sines_.data(), cosines_.size());
+    unnormalizedRotations_ = 0;
+  }
+}
+
+void golovin::RectangleBatch::print(std::ostream &out) const
+{
+  out << "RectangleBatch ";
+}
+
+std::shared_ptr<golovin::Shape> golovin::RectangleBatch::clone() const
+{
+  return std::make_shared<RectangleBatch>(*this);
+}
+
+bool golovin::RectangleBatch::contains(const point_t &point) const noexcept
+{
+  bool isFound = false;
+  for (size_t i = 0; i < widths_.size(); ++i)
+  {
+    const double dX = point.x - xs_[i];
+    const double dY = point.y - ys_[i];
+    isFound |= (std::fabs(dX * cosines_[i] + dY * sines_[i]) <= widths_[i] / 2.0)
+        && (std::fabs(dY * cosines_[i] - dX * sines_[i]) <= heights_[i] / 2.0);
+  }
+  return isFound;
+}
@@ -0,0 +1,61 @@
+#ifndef A4_RECTANGLE_BATCH_HPP
+#define A4_RECTANGLE_BATCH_HPP
+
+#include <vector>
+#include "shape.hpp"
+#include "rectangle.hpp"
+#include "base-types.hpp"
+
+namespace golovin
+{
+  class RectangleBatch : public Shape
+  {
+  public:
+    RectangleBatch() noexcept;
+
+    void pushBack(const point_t &center, double width, double height);
+
+    void reserve(size_t capacity);
+
+    Rectangle operator[](size_t) const;
+
+    size_t getSize() const noexcept;
+
+    bool isEmpty() const noexcept;
+
+    double getArea() const noexcept override;
+
+    rectangle_t getFrameRect() const override;
+
+    bool tryGetFrameRect(rectangle_t &) const noexcept override;
+
+    void scale(double) override;
+
+    void move(const point_t &) override;
+
+    void move(double dX, double dY) noexcept override;
+
+    point_t getPos() const override;
+
+    void rotate(double) override;
+
+    void print(std::ostream &) const override;
+
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const noexcept override;
+
+  private:
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> widths_;
+    std::vector<double> heights_;
+    std::vector<double> cosines_;
+    std::vector<double> sines_;
+    //Each rotate() turns the (cos, sin) pairs and adds rounding error to their length, so they are
+    //scaled back to unit length after this many rotations.
+    size_t unnormalizedRotations_;
+  };
+}
+
+#endif //A4_RECTANGLE_BATCH_HPP
@@ -6,7 +6,9 @@ golovin::Rectangle::Rectangle(const point_t &center, double width, double height
   center_(center),
   width_(width),
   height_(height),
-  angle_(0.0)
+  angle_(0.0),
+  cosAngle_(1.0),
+  sinAngle_(0.0)
 {
   if ((width_ <= 0.0) || (height_ <= 0.0))
   {
@@ -21,10 +23,8 @@ double golovin::Rectangle::getArea() const noexcept
 
 golovin::rectangle_t golovin::Rectangle::getFrameRect() const noexcept
 {
-  const double PI_IN_DEGREES = 180.0;
-  const double angleRadian = angle_ * (M_PI / PI_IN_DEGREES);
-  const double sinAngle = std::fabs(std::sin(angleRadian));
-  const double cosAngle = std::fabs(std::cos(angleRadian));
+  const double sinAngle = std::fabs(sinAngle_);
+  const double cosAngle = std::fabs(cosAngle_);
   const double frameWidth = height_ * sinAngle + width_ * cosAngle;
   const double frameHeight = height_ * cosAngle + width_ * sinAngle;
   return {frameWidth, frameHeight, center_};
@@ -53,16 +53,48 @@ void golovin::Rectangle::move(double dX, double dY) noexcept
 
 golovin::point_t golovin::Rectangle::getPos() const noexcept
 {
-  return getFrameRect().pos;
+  return center_;
 }
 
 void golovin::Rectangle::rotate(double angle) noexcept
 {
   const double FULL_TURN = 360.0;
+  const double PI_IN_DEGREES = 180.0;
   angle_ = std::fmod(angle_ + angle, FULL_TURN);
+  const double angleRadian = angle_ * (M_PI / PI_IN_DEGREES);
+  cosAngle_ = std::cos(angleRadian);
+  sinAngle_ = std::sin(angleRadian);
 }
 
 void golovin::Rectangle::print(std::ostream &out) const
 {
   out << "Rectangle ";
-}
\ No newline at end of file
+}
+
+std::shared_ptr<golovin::Shape> golovin::Rectangle::clone() const
+{
+  return std::make_shared<Rectangle>(*this);
+}
+
+bool golovin::Rectangle::contains(const point_t &point) const noexcept
+{
+  const double dX = point.x - center_.x;
+  const double dY = point.y - center_.y;
+  return (std::fabs(dX * cosAngle_ + dY * sinAngle_) <= width_ / 2.0)
+      && (std::fabs(dY * cosAngle_ - dX * sinAngle_) <= height_ / 2.0);
+}
+
+double golovin::Rectangle::getWidth() const noexcept
+{
+  return width_;
+}
+
+double golovin::Rectangle::getHeight() const noexcept
+{
+  return height_;
+}
+
+double golovin::Rectangle::getAngle() const noexcept
+{
+  return angle_;
+}
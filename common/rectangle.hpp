@@ -27,11 +27,23 @@ namespace golovin
 
     void print(std::ostream &) const override;
 
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const noexcept override;
+
+    double getWidth() const noexcept;
+
+    double getHeight() const noexcept;
+
+    double getAngle() const noexcept;
+
   private:
     point_t center_;
     double width_;
     double height_;
     double angle_;
+    double cosAngle_;
+    double sinAngle_;
   };
 }
 
@@ -0,0 +1,355 @@
+#include "scene-format.hpp"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+#include "rectangle.hpp"
+#include "circle.hpp"
+#include "triangle.hpp"
+#include "polygon.hpp"
+
+namespace
+{
+  const char MAGIC[] = {'A', '4', 'S', 'C'};
+  const uint32_t BYTE_ORDER_MARK = 0x01020304;
+  const uint64_t ALIGNMENT = 8;
+
+  using golovin::scene::VERSION;
+  using golovin::scene::RECTANGLE_STRIDE;
+  using golovin::scene::CIRCLE_STRIDE;
+  using golovin::scene::TRIANGLE_STRIDE;
+  using golovin::scene::MAX_DEPTH;
+  using golovin::scene::cursor_t;
+  using golovin::scene::header_t;
+  using golovin::scene::kind_t;
+  using golovin::scene::RECTANGLE_TAG;
+  using golovin::scene::CIRCLE_TAG;
+  using golovin::scene::TRIANGLE_TAG;
+  using golovin::scene::POLYGON_TAG;
+  using golovin::scene::COMPOSITE_TAG;
+
+  struct columns_t
+  {
+    std::vector<uint8_t> tags;
+    std::vector<uint64_t> childCounts;
+    std::vector<uint64_t> vertexCounts;
+    std::vector<uint64_t> layerSizes;
+    std::vector<cursor_t> layerCursors;
+    std::vector<double> rectangles;
+    std::vector<double> circles;
+    std::vector<double> triangles;
+    std::vector<golovin::point_t> points;
+  };
+
+  void startLayer(columns_t &columns, size_t size)
+  {
+    columns.layerSizes.push_back(size);
+    columns.layerCursors.push_back({columns.tags.size(), columns.childCounts.size(), columns.vertexCounts.size(),
+        columns.rectangles.size(), columns.circles.size(), columns.triangles.size(), columns.points.size()});
+  }
+
+  void collect(const golovin::Shape &shape, columns_t &columns, size_t depth)
+  {
+    const std::type_info &type = typeid(shape);
+    if (type == typeid(golovin::Rectangle))
+    {
+      const golovin::Rectangle &rectangle = static_cast<const golovin::Rectangle &>(shape);
+      const golovin::point_t center = rectangle.getPos();
+      const double record[] = {center.x, center.y, rectangle.getWidth(), rectangle.getHeight(), rectangle.getAngle()};
+      columns.tags.push_back(RECTANGLE_TAG);
+      columns.rectangles.insert(columns.rectangles.end(), record, record + RECTANGLE_STRIDE);
+    }
+    else if (type == typeid(golovin::Circle))
+    {
+      const golovin::Circle &circle = static_cast<const golovin::Circle &>(shape);
+      const golovin::point_t center = circle.getPos();
+      const double record[] = {center.x, center.y, circle.getRadius()};
+      columns.tags.push_back(CIRCLE_TAG);
+      columns.circles.insert(columns.circles.end(), record, record + CIRCLE_STRIDE);
+    }
+    else if (type == typeid(golovin::Triangle))
+    {
+      const golovin::Triangle &triangle = static_cast<const golovin::Triangle &>(shape);
+      const golovin::point_t a = triangle.getVertex(0);
+      const golovin::point_t b = triangle.getVertex(1);
+      const golovin::point_t c = triangle.getVertex(2);
+      const double record[] = {a.x, a.y, b.x, b.y, c.x, c.y};
+      //Throws for a triangle the loader would reject.
+      static_cast<void>(golovin::Triangle(a, b, c));
+      columns.tags.push_back(TRIANGLE_TAG);
+      columns.triangles.insert(columns.triangles.end(), record, record + TRIANGLE_STRIDE);
+    }
+    else if (type == typeid(golovin::Polygon))
+    {
+      const golovin::Polygon &polygon = static_cast<const golovin::Polygon &>(shape);
+      const size_t first = columns.points.size();
+      for (size_t i = 0; i < polygon.getVertexCount(); ++i)
+      {
+        columns.points.push_back(polygon.getVertex(i));
+      }
+      static_cast<void>(golovin::Polygon(columns.points.data() + first, polygon.getVertexCount()));
+      columns.tags.push_back(POLYGON_TAG);
+      columns.vertexCounts.push_back(polygon.getVertexCount());
+    }
+    else if (type == typeid(golovin::CompositeShape))
+    {
+      const golovin::CompositeShape &composite = static_cast<const golovin::CompositeShape &>(shape);
+      if (depth == MAX_DEPTH)
+      {
+        throw std::invalid_argument("Composite shapes are nested too deeply");
+      }
+      columns.tags.push_back(COMPOSITE_TAG);
+      columns.childCounts.push_back(composite.getSize());
+      for (size_t i = 0; i < composite.getSize(); ++i)
+      {
+        collect(*composite[i], columns, depth + 1);
+      }
+    }
+    else
+    {
+      throw std::invalid_argument("Unsupported shape type");
+    }
+  }
+
+  template <typename T>
+  void writeColumn(std::ostream &out, const std::vector<T> &column)
+  {
+    const uint64_t count = column.size();
+    const uint64_t bytes = count * sizeof(T);
+    const char padding[ALIGNMENT] = {};
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(column.data()), bytes);
+    out.write(padding, (ALIGNMENT - bytes % ALIGNMENT) % ALIGNMENT);
+  }
+
+  template <typename T>
+  void readColumn(std::istream &in, std::vector<T> &column)
+  {
+    uint64_t count = 0;
+    in.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if (!in || (count > std::numeric_limits<size_t>::max() / sizeof(T)))
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+    const uint64_t bytes = count * sizeof(T);
+    char padding[ALIGNMENT];
+    column.resize(count);
+    in.read(reinterpret_cast<char *>(column.data()), bytes);
+    in.read(padding, (ALIGNMENT - bytes % ALIGNMENT) % ALIGNMENT);
+    if (!in)
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+  }
+
+  void write(std::ostream &out, kind_t kind, const columns_t &columns)
+  {
+    header_t header{{}, VERSION, kind, BYTE_ORDER_MARK};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeColumn(out, columns.tags);
+    writeColumn(out, columns.childCounts);
+    writeColumn(out, columns.vertexCounts);
+    writeColumn(out, columns.layerSizes);
+    writeColumn(out, columns.layerCursors);
+    writeColumn(out, columns.rectangles);
+    writeColumn(out, columns.circles);
+    writeColumn(out, columns.triangles);
+    writeColumn(out, columns.points);
+    if (!out)
+    {
+      throw std::runtime_error("Failed to write scene");
+    }
+  }
+
+  void read(std::istream &in, kind_t kind, columns_t &columns)
+  {
+    header_t header{};
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!in)
+    {
+      throw std::invalid_argument("Not a scene file");
+    }
+    golovin::scene::checkHeader(header, kind);
+    readColumn(in, columns.tags);
+    readColumn(in, columns.childCounts);
+    readColumn(in, columns.vertexCounts);
+    readColumn(in, columns.layerSizes);
+    readColumn(in, columns.layerCursors);
+    readColumn(in, columns.rectangles);
+    readColumn(in, columns.circles);
+    readColumn(in, columns.triangles);
+    readColumn(in, columns.points);
+  }
+
+  template <typename T>
+  const T* take(const std::vector<T> &column, uint64_t &cursor, size_t count)
+  {
+    if (count > column.size() - cursor)
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+    cursor += count;
+    return column.data() + cursor - count;
+  }
+
+  void readChildren(const columns_t &columns, cursor_t &cursor, golovin::CompositeShape &target, size_t depth)
+  {
+    const uint64_t count = *take(columns.childCounts, cursor.childCount, 1);
+    if (count > columns.tags.size() - cursor.tag)
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+    target.reserve(count);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+      switch (*take(columns.tags, cursor.tag, 1))
+      {
+        case RECTANGLE_TAG:
+        {
+          const double *record = take(columns.rectangles, cursor.rectangle, RECTANGLE_STRIDE);
+          target.emplaceBack<golovin::Rectangle>(golovin::point_t{record[0], record[1]}, record[2], record[3])
+              .rotate(record[4]);
+          break;
+        }
+        case CIRCLE_TAG:
+        {
+          const double *record = take(columns.circles, cursor.circle, CIRCLE_STRIDE);
+          target.emplaceBack<golovin::Circle>(golovin::point_t{record[0], record[1]}, record[2]);
+          break;
+        }
+        case TRIANGLE_TAG:
+        {
+          const double *record = take(columns.triangles, cursor.triangle, TRIANGLE_STRIDE);
+          target.emplaceBack<golovin::Triangle>(golovin::point_t{record[0], record[1]},
+              golovin::point_t{record[2], record[3]}, golovin::point_t{record[4], record[5]});
+          break;
+        }
+        case POLYGON_TAG:
+        {
+          const uint64_t size = *take(columns.vertexCounts, cursor.vertexCount, 1);
+          if (size > columns.points.size() - cursor.point)
+          {
+            throw std::invalid_argument("Scene data is corrupted");
+          }
+          const golovin::point_t *points = take(columns.points, cursor.point, size);
+          target.emplaceBack<golovin::Polygon>(points, size, golovin::Polygon::allocator_type(target.getAllocator()));
+          break;
+        }
+        case COMPOSITE_TAG:
+          if (depth == MAX_DEPTH)
+          {
+            throw std::invalid_argument("Scene data is corrupted");
+          }
+          readChildren(columns, cursor, target.emplaceBack<golovin::CompositeShape>(target.getAllocator()), depth + 1);
+          break;
+        default:
+          throw std::invalid_argument("Scene data is corrupted");
+      }
+    }
+  }
+
+  void build(const columns_t &columns, golovin::CompositeShape &target)
+  {
+    cursor_t cursor{};
+    if (*take(columns.tags, cursor.tag, 1) != COMPOSITE_TAG)
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+    readChildren(columns, cursor, target, 0);
+    if ((cursor.tag != columns.tags.size()) || (cursor.childCount != columns.childCounts.size())
+        || (cursor.vertexCount != columns.vertexCounts.size()) || (cursor.rectangle != columns.rectangles.size())
+        || (cursor.circle != columns.circles.size()) || (cursor.triangle != columns.triangles.size())
+        || (cursor.point != columns.points.size()))
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+  }
+}
+
+void golovin::scene::checkHeader(const header_t &header, kind_t kind)
+{
+  if ((std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) || (header.byteOrder != BYTE_ORDER_MARK))
+  {
+    throw std::invalid_argument("Not a scene file");
+  }
+  if (header.version != VERSION)
+  {
+    throw std::invalid_argument("Unsupported scene version");
+  }
+  if (header.kind != kind)
+  {
+    throw std::invalid_argument("Unexpected scene kind");
+  }
+}
+
+void golovin::scene::save(std::ostream &out, const CompositeShape &composite)
+{
+  columns_t columns;
+  columns.tags.push_back(COMPOSITE_TAG);
+  columns.childCounts.push_back(composite.getSize());
+  startLayer(columns, composite.getSize());
+  for (size_t i = 0; i < composite.getSize(); ++i)
+  {
+    collect(*composite[i], columns, 0);
+  }
+  write(out, COMPOSITE_SCENE, columns);
+}
+
+void golovin::scene::save(std::ostream &out, const MatrixShape &matrix)
+{
+  columns_t columns;
+  columns.tags.push_back(COMPOSITE_TAG);
+  columns.childCounts.push_back(0);
+  for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+  {
+    const LayerView layer = matrix[i];
+    startLayer(columns, layer.getSize());
+    columns.childCounts.front() += layer.getSize();
+    for (const MatrixShape::shapePointer &shape : layer)
+    {
+      collect(*shape, columns, 0);
+    }
+  }
+  write(out, MATRIX_SCENE, columns);
+}
+
+golovin::CompositeShape golovin::scene::loadComposite(std::istream &in,
+    const CompositeShape::allocator_type &allocator)
+{
+  columns_t columns;
+  read(in, COMPOSITE_SCENE, columns);
+  CompositeShape composite(allocator);
+  build(columns, composite);
+  return composite;
+}
+
+golovin::MatrixShape golovin::scene::loadMatrix(std::istream &in, const CompositeShape::allocator_type &allocator)
+{
+  columns_t columns;
+  read(in, MATRIX_SCENE, columns);
+  CompositeShape composite(allocator);
+  build(columns, composite);
+  std::vector<size_t> rows;
+  rows.reserve(composite.getSize());
+  for (size_t i = 0; i < columns.layerSizes.size(); ++i)
+  {
+    if ((columns.layerSizes[i] == 0) || (columns.layerSizes[i] > composite.getSize() - rows.size()))
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+    rows.insert(rows.end(), columns.layerSizes[i], i);
+  }
+  if (rows.size() != composite.getSize())
+  {
+    throw std::invalid_argument("Scene data is corrupted");
+  }
+  if (composite.isEmpty())
+  {
+    return MatrixShape(allocator);
+  }
+  return MatrixShape(composite, rows, allocator);
+}
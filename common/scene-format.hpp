@@ -0,0 +1,78 @@
+#ifndef A4_SCENE_FORMAT_HPP
+#define A4_SCENE_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "composite-shape.hpp"
+#include "matrix.hpp"
+
+namespace golovin
+{
+  namespace scene
+  {
+    const uint32_t VERSION = 1;
+    const size_t RECTANGLE_STRIDE = 5;
+    const size_t CIRCLE_STRIDE = 3;
+    const size_t TRIANGLE_STRIDE = 6;
+    //Composites nested deeper than this are neither saved nor loaded, so a file cannot exhaust the stack.
+    const size_t MAX_DEPTH = 256;
+
+    enum kind_t : uint32_t
+    {
+      COMPOSITE_SCENE,
+      MATRIX_SCENE
+    };
+
+    enum tag_t : uint8_t
+    {
+      RECTANGLE_TAG,
+      CIRCLE_TAG,
+      TRIANGLE_TAG,
+      POLYGON_TAG,
+      COMPOSITE_TAG
+    };
+
+    struct header_t
+    {
+      char magic[4];
+      uint32_t version;
+      uint32_t kind;
+      uint32_t byteOrder;
+    };
+
+    //Position in every column; stored per layer so a reader can start at any layer.
+    struct cursor_t
+    {
+      uint64_t tag;
+      uint64_t childCount;
+      uint64_t vertexCount;
+      uint64_t rectangle;
+      uint64_t circle;
+      uint64_t triangle;
+      uint64_t point;
+    };
+
+    //Columns follow the header in this order, each as a uint64_t count and the packed values padded to 8 bytes:
+    //tags, child counts, polygon vertex counts, layer sizes, layer cursors, rectangles (x, y, width, height,
+    //angle), circles (x, y, radius), triangles (three vertices) and polygon points.
+    void checkHeader(const header_t &, kind_t);
+
+    //Binary, versioned. Shapes are stored as one column per type (and one column of type tags in
+    //depth-first order), so saving and loading are a handful of bulk reads and writes. Saving checks
+    //triangles and polygons with the constructors loading uses, so a shape that would not load back
+    //(one scaled below the minimal area, say) is rejected here.
+    void save(std::ostream &, const CompositeShape &);
+
+    void save(std::ostream &, const MatrixShape &);
+
+    CompositeShape loadComposite(std::istream &,
+        const CompositeShape::allocator_type &allocator = CompositeShape::allocator_type());
+
+    MatrixShape loadMatrix(std::istream &,
+        const CompositeShape::allocator_type &allocator = CompositeShape::allocator_type());
+  }
+}
+
+#endif //A4_SCENE_FORMAT_HPP
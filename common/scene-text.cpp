@@ -0,0 +1,271 @@
+#include "scene-text.hpp"
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "rectangle.hpp"
+#include "circle.hpp"
+#include "triangle.hpp"
+#include "polygon.hpp"
+
+const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+const int MAX_EXACT_POWER = 22;
+const int MAX_EXACT_DIGITS = 15;
+const int MAX_EXPONENT = 100000;
+
+static bool isSeparator(char symbol) noexcept
+{
+  return (symbol == ' ') || (symbol == '\t') || (symbol == ',') || (symbol == '(') || (symbol == ')')
+      || (symbol == '\r');
+}
+
+static bool isDigit(char symbol) noexcept
+{
+  return (symbol >= '0') && (symbol <= '9');
+}
+
+static const char* parseNumber(const char *first, const char *last, double &value)
+{
+  const char *current = first;
+  const bool isNegative = (current != last) && (*current == '-');
+  if ((current != last) && ((*current == '-') || (*current == '+')))
+  {
+    ++current;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool hasDigits = false;
+  for (; (current != last) && isDigit(*current); ++current)
+  {
+    hasDigits = true;
+    if ((mantissa != 0) || (*current != '0'))
+    {
+      mantissa = (digits <= MAX_EXACT_DIGITS) ? mantissa * 10 + (*current - '0') : mantissa;
+      ++digits;
+    }
+  }
+  if ((current != last) && (*current == '.'))
+  {
+    for (++current; (current != last) && isDigit(*current); ++current)
+    {
+      hasDigits = true;
+      if ((mantissa != 0) || (*current != '0'))
+      {
+        mantissa = (digits <= MAX_EXACT_DIGITS) ? mantissa * 10 + (*current - '0') : mantissa;
+        ++digits;
+      }
+      --exponent;
+    }
+  }
+  if (!hasDigits)
+  {
+    throw std::invalid_argument("Malformed number");
+  }
+  if ((current != last) && ((*current == 'e') || (*current == 'E')))
+  {
+    ++current;
+    const bool isNegativeExponent = (current != last) && (*current == '-');
+    if ((current != last) && ((*current == '-') || (*current == '+')))
+    {
+      ++current;
+    }
+    if ((current == last) || !isDigit(*current))
+    {
+      throw std::invalid_argument("Malformed number");
+    }
+    int power = 0;
+    for (; (current != last) && isDigit(*current); ++current)
+    {
+      power = std::min(MAX_EXPONENT, power * 10 + (*current - '0'));
+    }
+    exponent += isNegativeExponent ? -power : power;
+  }
+  if ((current != last) && !isSeparator(*current))
+  {
+    throw std::invalid_argument("Malformed number");
+  }
+  if ((digits <= MAX_EXACT_DIGITS) && (exponent >= -MAX_EXACT_POWER) && (exponent <= MAX_EXACT_POWER))
+  {
+    const double magnitude = static_cast<double>(mantissa);
+    value = (exponent < 0) ? magnitude / POWERS_OF_TEN[-exponent] : magnitude * POWERS_OF_TEN[exponent];
+  }
+  else
+  {
+    //The classic locale keeps '.' as the decimal point whatever the global locale is.
+    std::istringstream token(std::string(first, current));
+    token.imbue(std::locale::classic());
+    token >> value;
+    if (token.fail())
+    {
+      throw std::invalid_argument("Number is out of range");
+    }
+    return current;
+  }
+  if (isNegative)
+  {
+    value = -value;
+  }
+  return current;
+}
+
+static bool isKeyword(const char *first, const char *last, const char *keyword) noexcept
+{
+  for (; (first != last) && (*keyword != '\0'); ++first, ++keyword)
+  {
+    if (std::toupper(static_cast<unsigned char>(*first)) != *keyword)
+    {
+      return false;
+    }
+  }
+  return (first == last) && (*keyword == '\0');
+}
+
+static void dropClosingPoint(std::vector<golovin::point_t> &points) noexcept
+{
+  if ((points.size() > 3) && (points.front().x == points.back().x) && (points.front().y == points.back().y))
+  {
+    points.pop_back();
+  }
+}
+
+static bool parseLine(const char *first, const char *last, golovin::CompositeShape &target,
+    std::vector<double> &values, std::vector<golovin::point_t> &points)
+{
+  const char *comment = static_cast<const char *>(std::memchr(first, '#', last - first));
+  last = comment ? comment : last;
+  while ((first != last) && isSeparator(*first))
+  {
+    ++first;
+  }
+  if (first == last)
+  {
+    return false;
+  }
+  const char *keyword = first;
+  while ((first != last) && std::isalpha(static_cast<unsigned char>(*first)))
+  {
+    ++first;
+  }
+  const char *keywordEnd = first;
+  values.clear();
+  while (true)
+  {
+    while ((first != last) && isSeparator(*first))
+    {
+      ++first;
+    }
+    if (first == last)
+    {
+      break;
+    }
+    double value = 0.0;
+    first = parseNumber(first, last, value);
+    values.push_back(value);
+  }
+  if (isKeyword(keyword, keywordEnd, "RECTANGLE"))
+  {
+    if ((values.size() != 4) && (values.size() != 5))
+    {
+      throw std::invalid_argument("Rectangle needs a center, width, height and an optional angle");
+    }
+    golovin::Rectangle &rectangle = target.emplaceBack<golovin::Rectangle>(golovin::point_t{values[0], values[1]},
+        values[2], values[3]);
+    if (values.size() == 5)
+    {
+      rectangle.rotate(values[4]);
+    }
+    return true;
+  }
+  if (isKeyword(keyword, keywordEnd, "CIRCLE"))
+  {
+    if (values.size() != 3)
+    {
+      throw std::invalid_argument("Circle needs a center and a radius");
+    }
+    target.emplaceBack<golovin::Circle>(golovin::point_t{values[0], values[1]}, values[2]);
+    return true;
+  }
+  const bool isTriangle = isKeyword(keyword, keywordEnd, "TRIANGLE");
+  if (!isTriangle && !isKeyword(keyword, keywordEnd, "POLYGON"))
+  {
+    throw std::invalid_argument("Unknown shape type");
+  }
+  if (values.size() % 2 != 0)
+  {
+    throw std::invalid_argument("Vertex has no pair coordinate");
+  }
+  points.clear();
+  for (size_t i = 0; i < values.size(); i += 2)
+  {
+    points.push_back({values[i], values[i + 1]});
+  }
+  dropClosingPoint(points);
+  if (!isTriangle)
+  {
+    target.emplaceBack<golovin::Polygon>(points.data(), points.size(),
+        golovin::Polygon::allocator_type(target.getAllocator()));
+    return true;
+  }
+  if (points.size() != 3)
+  {
+    throw std::invalid_argument("Triangle needs three vertices");
+  }
+  target.emplaceBack<golovin::Triangle>(points[0], points[1], points[2]);
+  return true;
+}
+
+size_t golovin::scene::parseText(std::istream &in, CompositeShape &target, size_t chunkSize)
+{
+  if (chunkSize == 0)
+  {
+    throw std::invalid_argument("Chunk size must be > 0");
+  }
+  std::vector<char> buffer(chunkSize);
+  std::vector<double> values;
+  std::vector<point_t> points;
+  size_t begin = 0;
+  size_t end = 0;
+  size_t line = 0;
+  size_t count = 0;
+  bool isEnd = false;
+  while ((begin != end) || !isEnd)
+  {
+    const char *newline = static_cast<const char *>(std::memchr(buffer.data() + begin, '\n', end - begin));
+    if (!newline && !isEnd)
+    {
+      std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+      end -= begin;
+      begin = 0;
+      if (end == buffer.size())
+      {
+        buffer.resize(buffer.size() * 2);
+      }
+      in.read(buffer.data() + end, buffer.size() - end);
+      end += in.gcount();
+      if (in.bad())
+      {
+        throw std::runtime_error("Failed to read scene");
+      }
+      isEnd = !in;
+      continue;
+    }
+    const char *lineEnd = newline ? newline : buffer.data() + end;
+    ++line;
+    try
+    {
+      count += parseLine(buffer.data() + begin, lineEnd, target, values, points);
+    }
+    catch (const std::exception &)
+    {
+      std::throw_with_nested(std::invalid_argument("Failed to parse line " + std::to_string(line)));
+    }
+    begin = lineEnd - buffer.data() + (newline ? 1 : 0);
+  }
+  return count;
+}
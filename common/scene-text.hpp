@@ -0,0 +1,24 @@
+#ifndef A4_SCENE_TEXT_HPP
+#define A4_SCENE_TEXT_HPP
+
+#include <cstddef>
+#include <istream>
+#include "composite-shape.hpp"
+
+namespace golovin
+{
+  namespace scene
+  {
+    const size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    //One shape per line, keyword first; parentheses and commas are separators, and '#' starts a comment
+    //that runs to the end of the line. Numbers always use '.' as the decimal point:
+    //  RECTANGLE (x y, width height[, angle])     CIRCLE (x y, radius)
+    //  TRIANGLE ((x y, x y, x y[, x y]))          POLYGON ((x y, x y, x y, ...))
+    //A closing vertex equal to the first one, as WKT rings have, is dropped. Input is read in chunks of
+    //chunkSize bytes; shapes parsed before a failing line stay appended. Returns the number of shapes added.
+    size_t parseText(std::istream &, CompositeShape &, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+  }
+}
+
+#endif //A4_SCENE_TEXT_HPP
@@ -0,0 +1,432 @@
+#include "scene-view.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "batch-kernels.hpp"
+
+const size_t ALIGNMENT = 8;
+const size_t MIN_POLYGON_SIZE = 3;
+
+template <typename T>
+static const T* take(const T *data, size_t size, uint64_t &cursor, size_t count)
+{
+  if ((cursor > size) || (count > size - cursor))
+  {
+    throw std::invalid_argument("Scene data is corrupted");
+  }
+  cursor += count;
+  return data + cursor - count;
+}
+
+static double getLeafArea(golovin::scene::tag_t tag, const double *values, size_t count) noexcept
+{
+  switch (tag)
+  {
+    case golovin::scene::RECTANGLE_TAG:
+      return values[2] * values[3];
+    case golovin::scene::CIRCLE_TAG:
+      return M_PI * values[2] * values[2];
+    case golovin::scene::TRIANGLE_TAG:
+      return std::fabs(values[0] * (values[3] - values[5]) + values[2] * (values[5] - values[1])
+          + values[4] * (values[1] - values[3])) / 2.0;
+    default:
+      double area = 0.0;
+      for (size_t i = 0; i < count; ++i)
+      {
+        const size_t next = (i + 1) % count;
+        area += values[2 * i] * values[2 * next + 1] - values[2 * i + 1] * values[2 * next];
+      }
+      return std::fabs(area) / 2.0;
+  }
+}
+
+static golovin::kernels::bounds_t getLeafBounds(golovin::scene::tag_t tag, const double *values, size_t count) noexcept
+{
+  switch (tag)
+  {
+    case golovin::scene::RECTANGLE_TAG:
+    {
+      const double PI_IN_DEGREES = 180.0;
+      const double angleRadian = values[4] * (M_PI / PI_IN_DEGREES);
+      const double sinAngle = std::fabs(std::sin(angleRadian));
+      const double cosAngle = std::fabs(std::cos(angleRadian));
+      const double halfWidth = (values[3] * sinAngle + values[2] * cosAngle) / 2.0;
+      const double halfHeight = (values[3] * cosAngle + values[2] * sinAngle) / 2.0;
+      return {values[0] - halfWidth, values[0] + halfWidth, values[1] - halfHeight, values[1] + halfHeight};
+    }
+    case golovin::scene::CIRCLE_TAG:
+      return {values[0] - values[2], values[0] + values[2], values[1] - values[2], values[1] + values[2]};
+    default:
+      const size_t size = (tag == golovin::scene::TRIANGLE_TAG) ? 3 : count;
+      golovin::kernels::bounds_t bounds{values[0], values[0], values[1], values[1]};
+      for (size_t i = 1; i < size; ++i)
+      {
+        bounds.minX = std::min(bounds.minX, values[2 * i]);
+        bounds.maxX = std::max(bounds.maxX, values[2 * i]);
+        bounds.minY = std::min(bounds.minY, values[2 * i + 1]);
+        bounds.maxY = std::max(bounds.maxY, values[2 * i + 1]);
+      }
+      return bounds;
+  }
+}
+
+static bool isLeafContaining(golovin::scene::tag_t tag, const double *values, size_t count,
+    const golovin::point_t &point) noexcept
+{
+  switch (tag)
+  {
+    case golovin::scene::RECTANGLE_TAG:
+    {
+      const double PI_IN_DEGREES = 180.0;
+      const double angleRadian = values[4] * (M_PI / PI_IN_DEGREES);
+      const double sinAngle = std::sin(angleRadian);
+      const double cosAngle = std::cos(angleRadian);
+      const double dX = point.x - values[0];
+      const double dY = point.y - values[1];
+      return (std::fabs(dX * cosAngle + dY * sinAngle) <= values[2] / 2.0)
+          && (std::fabs(dY * cosAngle - dX * sinAngle) <= values[3] / 2.0);
+    }
+    case golovin::scene::CIRCLE_TAG:
+    {
+      const double dX = point.x - values[0];
+      const double dY = point.y - values[1];
+      return dX * dX + dY * dY <= values[2] * values[2];
+    }
+    default:
+      const size_t size = (tag == golovin::scene::TRIANGLE_TAG) ? 3 : count;
+      bool hasNegative = false;
+      bool hasPositive = false;
+      for (size_t i = 0; i < size; ++i)
+      {
+        const size_t next = (i + 1) % size;
+        const double composition = (values[2 * next] - values[2 * i]) * (point.y - values[2 * i + 1])
+            - (values[2 * next + 1] - values[2 * i + 1]) * (point.x - values[2 * i]);
+        hasNegative |= (composition < 0.0);
+        hasPositive |= (composition > 0.0);
+      }
+      return !(hasNegative && hasPositive);
+  }
+}
+
+static golovin::kernels::bounds_t merge(const golovin::kernels::bounds_t &lhs,
+    const golovin::kernels::bounds_t &rhs) noexcept
+{
+  return {std::min(lhs.minX, rhs.minX), std::max(lhs.maxX, rhs.maxX),
+      std::min(lhs.minY, rhs.minY), std::max(lhs.maxY, rhs.maxY)};
+}
+
+golovin::ShapeRecord::ShapeRecord(const SceneView *scene, const scene::cursor_t &cursor) noexcept:
+  scene_(scene),
+  cursor_(cursor)
+{}
+
+golovin::scene::tag_t golovin::ShapeRecord::getType() const
+{
+  scene::cursor_t cursor = cursor_;
+  return static_cast<scene::tag_t>(*take(scene_->tags_.data, scene_->tags_.size, cursor.tag, 1));
+}
+
+double golovin::ShapeRecord::getArea() const
+{
+  double area = 0.0;
+  scene::cursor_t cursor = cursor_;
+  scene_->visit(cursor, [&area](scene::tag_t tag, const double *values, size_t count)
+  {
+    area += getLeafArea(tag, values, count);
+    return false;
+  });
+  return area;
+}
+
+golovin::rectangle_t golovin::ShapeRecord::getFrameRect() const
+{
+  bool isFound = false;
+  kernels::bounds_t bounds{};
+  scene::cursor_t cursor = cursor_;
+  scene_->visit(cursor, [&isFound, &bounds](scene::tag_t tag, const double *values, size_t count)
+  {
+    bounds = isFound ? merge(bounds, getLeafBounds(tag, values, count)) : getLeafBounds(tag, values, count);
+    isFound = true;
+    return false;
+  });
+  if (!isFound || scene_->hasEmptyComposite(cursor_.childCount, cursor.childCount))
+  {
+    throw std::logic_error("Array is empty");
+  }
+  return kernels::toRectangle(bounds);
+}
+
+bool golovin::ShapeRecord::contains(const point_t &point) const
+{
+  bool isFound = false;
+  scene::cursor_t cursor = cursor_;
+  scene_->visit(cursor, [&isFound, &point](scene::tag_t tag, const double *values, size_t count)
+  {
+    isFound = isFound || isLeafContaining(tag, values, count, point);
+    return isFound;
+  });
+  return isFound;
+}
+
+golovin::SceneView::SceneView(const std::string &path):
+  mapping_(nullptr),
+  bytes_(0),
+  isMatrix_(false),
+  tags_{nullptr, 0},
+  childCounts_{nullptr, 0},
+  vertexCounts_{nullptr, 0},
+  layerSizes_{nullptr, 0},
+  layerCursors_{nullptr, 0},
+  rectangles_{nullptr, 0},
+  circles_{nullptr, 0},
+  triangles_{nullptr, 0},
+  points_{nullptr, 0}
+{
+  const int file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    throw std::runtime_error("Failed to open scene file");
+  }
+  struct stat status{};
+  if ((::fstat(file, &status) != 0) || (static_cast<size_t>(status.st_size) < sizeof(scene::header_t)))
+  {
+    ::close(file);
+    throw std::invalid_argument("Not a scene file");
+  }
+  bytes_ = status.st_size;
+  void *mapping = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, file, 0);
+  ::close(file);
+  if (mapping == MAP_FAILED)
+  {
+    throw std::runtime_error("Failed to map scene file");
+  }
+  mapping_ = mapping;
+  try
+  {
+    scene::header_t header{};
+    std::memcpy(&header, mapping_, sizeof(header));
+    isMatrix_ = (header.kind == scene::MATRIX_SCENE);
+    scene::checkHeader(header, isMatrix_ ? scene::MATRIX_SCENE : scene::COMPOSITE_SCENE);
+    size_t offset = sizeof(header);
+    tags_ = mapColumn<uint8_t>(offset);
+    childCounts_ = mapColumn<uint64_t>(offset);
+    vertexCounts_ = mapColumn<uint64_t>(offset);
+    layerSizes_ = mapColumn<uint64_t>(offset);
+    layerCursors_ = mapColumn<scene::cursor_t>(offset);
+    rectangles_ = mapColumn<double>(offset);
+    circles_ = mapColumn<double>(offset);
+    triangles_ = mapColumn<double>(offset);
+    points_ = mapColumn<point_t>(offset);
+    if ((tags_.size == 0) || (tags_.data[0] != scene::COMPOSITE_TAG) || (childCounts_.size == 0)
+        || (layerSizes_.size != layerCursors_.size))
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+  }
+  catch (...)
+  {
+    ::munmap(mapping_, bytes_);
+    throw;
+  }
+}
+
+golovin::SceneView::~SceneView()
+{
+  ::munmap(mapping_, bytes_);
+}
+
+bool golovin::SceneView::isMatrix() const noexcept
+{
+  return isMatrix_;
+}
+
+size_t golovin::SceneView::getSize() const noexcept
+{
+  return childCounts_.data[0];
+}
+
+size_t golovin::SceneView::getLayerCount() const noexcept
+{
+  return layerSizes_.size;
+}
+
+size_t golovin::SceneView::getLayerSize(size_t layer) const
+{
+  if (layer >= layerSizes_.size)
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return layerSizes_.data[layer];
+}
+
+void golovin::SceneView::getLayer(size_t layer, std::vector<ShapeRecord> &result) const
+{
+  const size_t size = getLayerSize(layer);
+  scene::cursor_t cursor = layerCursors_.data[layer];
+  result.clear();
+  for (size_t i = 0; i < size; ++i)
+  {
+    result.push_back(ShapeRecord(this, cursor));
+    visit(cursor, [](scene::tag_t, const double *, size_t)
+    {
+      return false;
+    });
+  }
+}
+
+double golovin::SceneView::getArea() const
+{
+  double area = 0.0;
+  forEachLeaf([&area](scene::tag_t tag, const double *values, size_t count)
+  {
+    area += getLeafArea(tag, values, count);
+    return false;
+  });
+  return area;
+}
+
+golovin::rectangle_t golovin::SceneView::getFrameRect() const
+{
+  bool isFound = false;
+  kernels::bounds_t bounds{};
+  forEachLeaf([&isFound, &bounds](scene::tag_t tag, const double *values, size_t count)
+  {
+    bounds = isFound ? merge(bounds, getLeafBounds(tag, values, count)) : getLeafBounds(tag, values, count);
+    isFound = true;
+    return false;
+  });
+  if (!isFound || hasEmptyComposite(0, childCounts_.size))
+  {
+    throw std::logic_error("Array is empty");
+  }
+  return kernels::toRectangle(bounds);
+}
+
+bool golovin::SceneView::contains(const point_t &point) const
+{
+  bool isFound = false;
+  forEachLeaf([&isFound, &point](scene::tag_t tag, const double *values, size_t count)
+  {
+    isFound = isLeafContaining(tag, values, count, point);
+    return isFound;
+  });
+  return isFound;
+}
+
+size_t golovin::SceneView::getMappedBytes() const noexcept
+{
+  return bytes_;
+}
+
+template <typename T>
+golovin::SceneView::column_t<T> golovin::SceneView::mapColumn(size_t &offset) const
+{
+  uint64_t count = 0;
+  if (sizeof(count) > bytes_ - offset)
+  {
+    throw std::invalid_argument("Scene data is corrupted");
+  }
+  std::memcpy(&count, static_cast<const char *>(mapping_) + offset, sizeof(count));
+  offset += sizeof(count);
+  if (count > (bytes_ - offset) / sizeof(T))
+  {
+    throw std::invalid_argument("Scene data is corrupted");
+  }
+  const column_t<T> column{reinterpret_cast<const T *>(static_cast<const char *>(mapping_) + offset), count};
+  offset = std::min(bytes_, offset + (count * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+  return column;
+}
+
+template <typename Function>
+void golovin::SceneView::visit(scene::cursor_t &cursor, Function function, size_t depth) const
+{
+  const scene::tag_t tag = static_cast<scene::tag_t>(*take(tags_.data, tags_.size, cursor.tag, 1));
+  switch (tag)
+  {
+    case scene::RECTANGLE_TAG:
+      function(tag, take(rectangles_.data, rectangles_.size, cursor.rectangle, scene::RECTANGLE_STRIDE),
+          scene::RECTANGLE_STRIDE);
+      break;
+    case scene::CIRCLE_TAG:
+      function(tag, take(circles_.data, circles_.size, cursor.circle, scene::CIRCLE_STRIDE), scene::CIRCLE_STRIDE);
+      break;
+    case scene::TRIANGLE_TAG:
+      function(tag, take(triangles_.data, triangles_.size, cursor.triangle, scene::TRIANGLE_STRIDE),
+          scene::TRIANGLE_STRIDE);
+      break;
+    case scene::POLYGON_TAG:
+    {
+      const uint64_t size = *take(vertexCounts_.data, vertexCounts_.size, cursor.vertexCount, 1);
+      if (size < MIN_POLYGON_SIZE)
+      {
+        throw std::invalid_argument("Scene data is corrupted");
+      }
+      function(tag, &take(points_.data, points_.size, cursor.point, size)->x, size);
+      break;
+    }
+    case scene::COMPOSITE_TAG:
+    {
+      const uint64_t count = *take(childCounts_.data, childCounts_.size, cursor.childCount, 1);
+      if (depth == scene::MAX_DEPTH)
+      {
+        throw std::invalid_argument("Scene data is corrupted");
+      }
+      for (uint64_t i = 0; i < count; ++i)
+      {
+        visit(cursor, function, depth + 1);
+      }
+      break;
+    }
+    default:
+      throw std::invalid_argument("Scene data is corrupted");
+  }
+}
+
+template <typename Function>
+void golovin::SceneView::forEachLeaf(Function function) const
+{
+  for (size_t i = 0; i + scene::RECTANGLE_STRIDE <= rectangles_.size; i += scene::RECTANGLE_STRIDE)
+  {
+    if (function(scene::RECTANGLE_TAG, rectangles_.data + i, scene::RECTANGLE_STRIDE))
+    {
+      return;
+    }
+  }
+  for (size_t i = 0; i + scene::CIRCLE_STRIDE <= circles_.size; i += scene::CIRCLE_STRIDE)
+  {
+    if (function(scene::CIRCLE_TAG, circles_.data + i, scene::CIRCLE_STRIDE))
+    {
+      return;
+    }
+  }
+  for (size_t i = 0; i + scene::TRIANGLE_STRIDE <= triangles_.size; i += scene::TRIANGLE_STRIDE)
+  {
+    if (function(scene::TRIANGLE_TAG, triangles_.data + i, scene::TRIANGLE_STRIDE))
+    {
+      return;
+    }
+  }
+  uint64_t point = 0;
+  for (size_t i = 0; i < vertexCounts_.size; ++i)
+  {
+    const uint64_t size = vertexCounts_.data[i];
+    if (size < MIN_POLYGON_SIZE)
+    {
+      throw std::invalid_argument("Scene data is corrupted");
+    }
+    if (function(scene::POLYGON_TAG, &take(points_.data, points_.size, point, size)->x, size))
+    {
+      return;
+    }
+  }
+}
+
+bool golovin::SceneView::hasEmptyComposite(uint64_t first, uint64_t last) const noexcept
+{
+  return std::find(childCounts_.data + first, childCounts_.data + last, 0) != childCounts_.data + last;
+}
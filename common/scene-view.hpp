@@ -0,0 +1,104 @@
+#ifndef A4_SCENE_VIEW_HPP
+#define A4_SCENE_VIEW_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "base-types.hpp"
+#include "scene-format.hpp"
+
+namespace golovin
+{
+  class SceneView;
+
+  class ShapeRecord
+  {
+  public:
+    scene::tag_t getType() const;
+
+    double getArea() const;
+
+    //Throws logic_error, as CompositeShape does, if the record holds an empty composite at any depth.
+    rectangle_t getFrameRect() const;
+
+    bool contains(const point_t &) const;
+
+  private:
+    friend class SceneView;
+
+    const SceneView *scene_;
+    scene::cursor_t cursor_;
+
+    ShapeRecord(const SceneView *, const scene::cursor_t &) noexcept;
+  };
+
+  //Read-only view of a file written by scene::save. The file is mapped, not parsed: opening it only checks
+  //the header and column extents, and every query reads the packed columns in place.
+  class SceneView
+  {
+  public:
+    explicit SceneView(const std::string &path);
+
+    SceneView(const SceneView &) = delete;
+
+    ~SceneView();
+
+    SceneView& operator=(const SceneView &) = delete;
+
+    bool isMatrix() const noexcept;
+
+    size_t getSize() const noexcept;
+
+    size_t getLayerCount() const noexcept;
+
+    size_t getLayerSize(size_t layer) const;
+
+    void getLayer(size_t layer, std::vector<ShapeRecord> &result) const;
+
+    //The whole-scene queries scan the shape columns without walking the tree; getFrameRect() still checks
+    //the composites, so it throws for an empty nested composite just like the loaded CompositeShape.
+    double getArea() const;
+
+    rectangle_t getFrameRect() const;
+
+    bool contains(const point_t &) const;
+
+    size_t getMappedBytes() const noexcept;
+
+  private:
+    friend class ShapeRecord;
+
+    template <typename T>
+    struct column_t
+    {
+      const T *data;
+      size_t size;
+    };
+
+    void *mapping_;
+    size_t bytes_;
+    bool isMatrix_;
+    column_t<uint8_t> tags_;
+    column_t<uint64_t> childCounts_;
+    column_t<uint64_t> vertexCounts_;
+    column_t<uint64_t> layerSizes_;
+    column_t<scene::cursor_t> layerCursors_;
+    column_t<double> rectangles_;
+    column_t<double> circles_;
+    column_t<double> triangles_;
+    column_t<point_t> points_;
+
+    template <typename T>
+    column_t<T> mapColumn(size_t &offset) const;
+
+    template <typename Function>
+    void visit(scene::cursor_t &cursor, Function function, size_t depth = 0) const;
+
+    template <typename Function>
+    void forEachLeaf(Function function) const;
+
+    bool hasEmptyComposite(uint64_t first, uint64_t last) const noexcept;
+  };
+}
+
+#endif //A4_SCENE_VIEW_HPP
@@ -2,6 +2,7 @@
 #define A1_SHAPE_HPP
 
 #include <ostream>
+#include <memory>
 #include "base-types.hpp"
 
 namespace golovin
@@ -11,21 +12,34 @@ namespace golovin
   public:
     virtual ~Shape() = default;
 
-    virtual double getArea() const noexcept = 0;
+    //Not noexcept: a deferred composite applies its pending transform first, which may fail.
+    virtual double getArea() const = 0;
 
     virtual rectangle_t getFrameRect() const = 0;
 
+    //Reports a missing frame (an empty container, possibly nested) by returning false instead of throwing.
+    virtual bool tryGetFrameRect(rectangle_t &frame) const
+    {
+      frame = getFrameRect();
+      return true;
+    }
+
     virtual void scale(double) = 0;
 
     virtual void move(const point_t &) = 0;
 
-    virtual void move(double dX, double dY) noexcept = 0;
+    //Not noexcept: a copy-on-write container may have to allocate before it can shift its children.
+    virtual void move(double dX, double dY) = 0;
 
     virtual point_t getPos() const = 0;
 
     virtual void rotate(double) = 0;
 
     virtual void print(std::ostream &) const = 0;
+
+    virtual std::shared_ptr<Shape> clone() const = 0;
+
+    virtual bool contains(const point_t &) const = 0;
   };
 }
 #endif
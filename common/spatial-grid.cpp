@@ -0,0 +1,166 @@
+#include "spatial-grid.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+const long long MAX_CELLS_PER_SHAPE = 64;
+//Cell numbers are clamped to [-MAX_CELL, MAX_CELL], so each fits in 32 bits and a range's cell count
+//cannot overflow; shapes beyond it share the border cells.
+const long long MAX_CELL = 1LL << 30;
+
+golovin::SpatialGrid::SpatialGrid(double cellSize):
+  cellSize_(cellSize),
+  size_(0)
+{
+  if (!(cellSize_ > 0.0))
+  {
+    throw std::invalid_argument("Cell size of the grid must be > 0");
+  }
+}
+
+void golovin::SpatialGrid::insert(size_t id, const rectangle_t &rectangle)
+{
+  const range_t range = getRange(rectangle);
+  if (isOversized(range))
+  {
+    oversized_.push_back(id);
+  }
+  else
+  {
+    for (long long x = range.minX; x <= range.maxX; ++x)
+    {
+      for (long long y = range.minY; y <= range.maxY; ++y)
+      {
+        cells_[getKey(x, y)].push_back(id);
+      }
+    }
+  }
+  ++size_;
+}
+
+void golovin::SpatialGrid::remove(size_t id, const rectangle_t &rectangle)
+{
+  const range_t range = getRange(rectangle);
+  if (isOversized(range))
+  {
+    erase(oversized_, id);
+  }
+  else
+  {
+    for (long long x = range.minX; x <= range.maxX; ++x)
+    {
+      for (long long y = range.minY; y <= range.maxY; ++y)
+      {
+        cellMap::iterator cell = cells_.find(getKey(x, y));
+        if (cell != cells_.end())
+        {
+          erase(cell->second, id);
+          if (cell->second.empty())
+          {
+            cells_.erase(cell);
+          }
+        }
+      }
+    }
+  }
+  --size_;
+}
+
+void golovin::SpatialGrid::query(const rectangle_t &rectangle, std::vector<size_t> &result) const
+{
+  result.clear();
+  const range_t range = getRange(rectangle);
+  if ((range.maxX - range.minX + 1) * (range.maxY - range.minY + 1) > static_cast<long long>(cells_.size()))
+  {
+    for (const cellMap::value_type &cell : cells_)
+    {
+      result.insert(result.end(), cell.second.begin(), cell.second.end());
+    }
+  }
+  else
+  {
+    for (long long x = range.minX; x <= range.maxX; ++x)
+    {
+      for (long long y = range.minY; y <= range.maxY; ++y)
+      {
+        cellMap::const_iterator cell = cells_.find(getKey(x, y));
+        if (cell != cells_.end())
+        {
+          result.insert(result.end(), cell->second.begin(), cell->second.end());
+        }
+      }
+    }
+  }
+  result.insert(result.end(), oversized_.begin(), oversized_.end());
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+void golovin::SpatialGrid::clear() noexcept
+{
+  cells_.clear();
+  oversized_.clear();
+  size_ = 0;
+}
+
+double golovin::SpatialGrid::getCellSize() const noexcept
+{
+  return cellSize_;
+}
+
+size_t golovin::SpatialGrid::getSize() const noexcept
+{
+  return size_;
+}
+
+golovin::SpatialGrid::range_t golovin::SpatialGrid::getRange(const rectangle_t &rectangle) const noexcept
+{
+  //A NaN bound widens the range to the whole grid, so such a shape is kept with the oversized ones.
+  return {toCell(std::floor((rectangle.pos.x - rectangle.width / 2.0) / cellSize_), -MAX_CELL),
+      toCell(std::floor((rectangle.pos.x + rectangle.width / 2.0) / cellSize_), MAX_CELL),
+      toCell(std::floor((rectangle.pos.y - rectangle.height / 2.0) / cellSize_), -MAX_CELL),
+      toCell(std::floor((rectangle.pos.y + rectangle.height / 2.0) / cellSize_), MAX_CELL)};
+}
+
+long long golovin::SpatialGrid::toCell(double cell, long long nanCell) noexcept
+{
+  if (std::isnan(cell))
+  {
+    return nanCell;
+  }
+  return static_cast<long long>(std::min(std::max(cell, static_cast<double>(-MAX_CELL)),
+      static_cast<double>(MAX_CELL)));
+}
+
+bool golovin::SpatialGrid::isOversized(const range_t &range) noexcept
+{
+  return (range.maxX - range.minX + 1) * (range.maxY - range.minY + 1) > MAX_CELLS_PER_SHAPE;
+}
+
+void golovin::SpatialGrid::erase(std::vector<size_t> &ids, size_t id) noexcept
+{
+  std::vector<size_t>::iterator position = std::find(ids.begin(), ids.end(), id);
+  if (position != ids.end())
+  {
+    *position = ids.back();
+    ids.pop_back();
+  }
+}
+
+long long golovin::SpatialGrid::getKey(long long x, long long y) noexcept
+{
+  return static_cast<long long>((static_cast<unsigned long long>(x) << 32)
+      | (static_cast<unsigned long long>(y) & 0xffffffffULL));
+}
+
+size_t golovin::SpatialGrid::hash_t::operator()(long long key) const noexcept
+{
+  //The 64-bit finaliser of MurmurHash3.
+  unsigned long long bits = static_cast<unsigned long long>(key);
+  bits ^= bits >> 33;
+  bits *= 0xff51afd7ed558ccdULL;
+  bits ^= bits >> 33;
+  bits *= 0xc4ceb93e7f3b4e53ULL;
+  bits ^= bits >> 33;
+  return static_cast<size_t>(bits);
+}
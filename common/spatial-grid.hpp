@@ -0,0 +1,63 @@
+#ifndef A4_SPATIAL_GRID_HPP
+#define A4_SPATIAL_GRID_HPP
+
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include "base-types.hpp"
+
+namespace golovin
+{
+  class SpatialGrid
+  {
+  public:
+    explicit SpatialGrid(double cellSize);
+
+    void insert(size_t id, const rectangle_t &);
+
+    void remove(size_t id, const rectangle_t &);
+
+    void query(const rectangle_t &, std::vector<size_t> &result) const;
+
+    void clear() noexcept;
+
+    double getCellSize() const noexcept;
+
+    size_t getSize() const noexcept;
+
+  private:
+    //Cell keys pack two clamped cell numbers, and std::hash<long long> keeps them as they are, so the
+    //bits are mixed before they pick a bucket.
+    struct hash_t
+    {
+      size_t operator()(long long key) const noexcept;
+    };
+
+    typedef std::unordered_map<long long, std::vector<size_t>, hash_t> cellMap;
+
+    struct range_t
+    {
+      long long minX;
+      long long maxX;
+      long long minY;
+      long long maxY;
+    };
+
+    double cellSize_;
+    size_t size_;
+    cellMap cells_;
+    std::vector<size_t> oversized_;
+
+    range_t getRange(const rectangle_t &) const noexcept;
+
+    static bool isOversized(const range_t &) noexcept;
+
+    static void erase(std::vector<size_t> &ids, size_t id) noexcept;
+
+    static long long getKey(long long x, long long y) noexcept;
+
+    static long long toCell(double cell, long long nanCell) noexcept;
+  };
+}
+
+#endif //A4_SPATIAL_GRID_HPP
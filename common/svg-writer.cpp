@@ -0,0 +1,339 @@
+#include "svg-writer.hpp"
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <typeinfo>
+#include "rectangle.hpp"
+#include "circle.hpp"
+#include "triangle.hpp"
+#include "polygon.hpp"
+#include "circle-batch.hpp"
+#include "rectangle-batch.hpp"
+#include "variant-composite-shape.hpp"
+#include "composite-snapshot.hpp"
+
+const double DECIMAL_SCALE = 1e6;
+const int DECIMAL_PLACES = 6;
+const double MAX_FIXED_VALUE = 1e12;
+const size_t MAX_NUMBER_SIZE = 32;
+
+static size_t formatInteger(uint64_t value, char *out) noexcept
+{
+  char digits[MAX_NUMBER_SIZE];
+  size_t count = 0;
+  do
+  {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  while (value != 0);
+  size_t size = 0;
+  while (count != 0)
+  {
+    out[size++] = digits[--count];
+  }
+  return size;
+}
+
+static size_t formatNumber(double value, char *out) noexcept
+{
+  if (!(std::fabs(value) < MAX_FIXED_VALUE))
+  {
+    return std::snprintf(out, MAX_NUMBER_SIZE, "%.17g", value);
+  }
+  const uint64_t scaled = static_cast<uint64_t>(std::llround(std::fabs(value) * DECIMAL_SCALE));
+  uint64_t fraction = scaled % static_cast<uint64_t>(DECIMAL_SCALE);
+  size_t size = 0;
+  if ((value < 0.0) && (scaled != 0))
+  {
+    out[size++] = '-';
+  }
+  size += formatInteger(scaled / static_cast<uint64_t>(DECIMAL_SCALE), out + size);
+  if (fraction != 0)
+  {
+    int places = DECIMAL_PLACES;
+    while (fraction % 10 == 0)
+    {
+      fraction /= 10;
+      --places;
+    }
+    out[size++] = '.';
+    for (int i = places - 1; i >= 0; --i)
+    {
+      out[size + i] = static_cast<char>('0' + fraction % 10);
+      fraction /= 10;
+    }
+    size += places;
+  }
+  return size;
+}
+
+golovin::SvgWriter::SvgWriter(size_t bufferSize):
+  buffer_(bufferSize),
+  size_(0),
+  out_(nullptr)
+{
+  if (bufferSize < MAX_NUMBER_SIZE)
+  {
+    throw std::invalid_argument("Buffer size is too small");
+  }
+}
+
+void golovin::SvgWriter::write(std::ostream &out, const CompositeShape &composite)
+{
+  out_ = &out;
+  size_ = 0;
+  writeHeader(composite.getFrameRect());
+  for (size_t i = 0; i < composite.getSize(); ++i)
+  {
+    writeShape(*composite[i]);
+  }
+  writeFooter();
+}
+
+void golovin::SvgWriter::write(std::ostream &out, const MatrixShape &matrix)
+{
+  out_ = &out;
+  size_ = 0;
+  bool isFound = false;
+  rectangle_t frame{0.0, 0.0, {0.0, 0.0}};
+  double minX = 0.0;
+  double maxX = 0.0;
+  double minY = 0.0;
+  double maxY = 0.0;
+  for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+  {
+    for (const MatrixShape::shapePointer &shape : matrix[i])
+    {
+      const rectangle_t current = shape->getFrameRect();
+      minX = isFound ? std::min(minX, current.pos.x - current.width / 2.0) : current.pos.x - current.width / 2.0;
+      maxX = isFound ? std::max(maxX, current.pos.x + current.width / 2.0) : current.pos.x + current.width / 2.0;
+      minY = isFound ? std::min(minY, current.pos.y - current.height / 2.0) : current.pos.y - current.height / 2.0;
+      maxY = isFound ? std::max(maxY, current.pos.y + current.height / 2.0) : current.pos.y + current.height / 2.0;
+      isFound = true;
+    }
+  }
+  if (isFound)
+  {
+    frame = {maxX - minX, maxY - minY, {(minX + maxX) / 2.0, (minY + maxY) / 2.0}};
+  }
+  writeHeader(frame);
+  for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+  {
+    append("<g id=\"layer-");
+    append(i);
+    append("\">\n");
+    for (const MatrixShape::shapePointer &shape : matrix[i])
+    {
+      writeShape(*shape);
+    }
+    append("</g>\n");
+  }
+  writeFooter();
+}
+
+void golovin::SvgWriter::writeShape(const Shape &shape)
+{
+  const std::type_info &type = typeid(shape);
+  if (type == typeid(Rectangle))
+  {
+    const Rectangle &rectangle = static_cast<const Rectangle &>(shape);
+    writeRectangle(rectangle.getPos(), rectangle.getWidth(), rectangle.getHeight(), rectangle.getAngle());
+  }
+  else if (type == typeid(Circle))
+  {
+    const Circle &circle = static_cast<const Circle &>(shape);
+    writeCircle(circle.getPos(), circle.getRadius());
+  }
+  else if (type == typeid(Triangle))
+  {
+    const Triangle &triangle = static_cast<const Triangle &>(shape);
+    append("<polygon points=\"");
+    writePoints(triangle.getVertex(0));
+    writePoints(triangle.getVertex(1));
+    writePoints(triangle.getVertex(2));
+    append("\"/>\n");
+  }
+  else if (type == typeid(Polygon))
+  {
+    const Polygon &polygon = static_cast<const Polygon &>(shape);
+    append("<polygon points=\"");
+    for (size_t i = 0; i < polygon.getVertexCount(); ++i)
+    {
+      writePoints(polygon.getVertex(i));
+    }
+    append("\"/>\n");
+  }
+  else if (type == typeid(CompositeShape))
+  {
+    const CompositeShape &composite = static_cast<const CompositeShape &>(shape);
+    append("<g>\n");
+    for (size_t i = 0; i < composite.getSize(); ++i)
+    {
+      writeShape(*composite[i]);
+    }
+    append("</g>\n");
+  }
+  else if (type == typeid(CompositeSnapshot))
+  {
+    const CompositeSnapshot &snapshot = static_cast<const CompositeSnapshot &>(shape);
+    append("<g>\n");
+    for (size_t i = 0; i < snapshot.getSize(); ++i)
+    {
+      writeShape(snapshot[i]);
+    }
+    append("</g>\n");
+  }
+  else if (type == typeid(VariantCompositeShape))
+  {
+    const VariantCompositeShape &variant = static_cast<const VariantCompositeShape &>(shape);
+    append("<g>\n");
+    for (size_t i = 0; i < variant.getSize(); ++i)
+    {
+      writeShape(boost::apply_visitor([](const auto &element) -> const Shape &
+      {
+        return element;
+      }, variant[i]));
+    }
+    append("</g>\n");
+  }
+  else if (type == typeid(CircleBatch))
+  {
+    const CircleBatch &batch = static_cast<const CircleBatch &>(shape);
+    append("<g>\n");
+    for (size_t i = 0; i < batch.getSize(); ++i)
+    {
+      const Circle circle = batch[i];
+      writeCircle(circle.getPos(), circle.getRadius());
+    }
+    append("</g>\n");
+  }
+  else if (type == typeid(RectangleBatch))
+  {
+    const RectangleBatch &batch = static_cast<const RectangleBatch &>(shape);
+    append("<g>\n");
+    for (size_t i = 0; i < batch.getSize(); ++i)
+    {
+      const Rectangle rectangle = batch[i];
+      writeRectangle(rectangle.getPos(), rectangle.getWidth(), rectangle.getHeight(), rectangle.getAngle());
+    }
+    append("</g>\n");
+  }
+  else
+  {
+    throw std::invalid_argument("Unsupported shape type");
+  }
+}
+
+void golovin::SvgWriter::writeRectangle(const point_t &center, double width, double height, double angle)
+{
+  append("<rect x=\"");
+  append(center.x - width / 2.0);
+  append("\" y=\"");
+  append(center.y - height / 2.0);
+  append("\" width=\"");
+  append(width);
+  append("\" height=\"");
+  append(height);
+  if (angle != 0.0)
+  {
+    append("\" transform=\"rotate(");
+    append(angle);
+    append(" ");
+    append(center.x);
+    append(" ");
+    append(center.y);
+    append(")");
+  }
+  append("\"/>\n");
+}
+
+void golovin::SvgWriter::writeCircle(const point_t &center, double radius)
+{
+  append("<circle cx=\"");
+  append(center.x);
+  append("\" cy=\"");
+  append(center.y);
+  append("\" r=\"");
+  append(radius);
+  append("\"/>\n");
+}
+
+void golovin::SvgWriter::writePoints(const point_t &point)
+{
+  append(point.x);
+  append(",");
+  append(point.y);
+  append(" ");
+}
+
+void golovin::SvgWriter::writeHeader(const rectangle_t &frame)
+{
+  append("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+  append(frame.pos.x - frame.width / 2.0);
+  append(" ");
+  append(-frame.pos.y - frame.height / 2.0);
+  append(" ");
+  append(frame.width);
+  append(" ");
+  append(frame.height);
+  append("\">\n<g transform=\"scale(1,-1)\">\n");
+}
+
+void golovin::SvgWriter::writeFooter()
+{
+  append("</g>\n</svg>\n");
+  flush();
+  out_ = nullptr;
+}
+
+void golovin::SvgWriter::append(const char *text)
+{
+  append(text, std::strlen(text));
+}
+
+void golovin::SvgWriter::append(const char *text, size_t size)
+{
+  if (size > buffer_.size() - size_)
+  {
+    flush();
+    if (size > buffer_.size())
+    {
+      out_->write(text, size);
+      return;
+    }
+  }
+  std::memcpy(buffer_.data() + size_, text, size);
+  size_ += size;
+}
+
+void golovin::SvgWriter::append(double value)
+{
+  if (MAX_NUMBER_SIZE > buffer_.size() - size_)
+  {
+    flush();
+  }
+  size_ += formatNumber(value, buffer_.data() + size_);
+}
+
+void golovin::SvgWriter::append(size_t value)
+{
+  if (MAX_NUMBER_SIZE > buffer_.size() - size_)
+  {
+    flush();
+  }
+  size_ += formatInteger(value, buffer_.data() + size_);
+}
+
+void golovin::SvgWriter::flush()
+{
+  out_->write(buffer_.data(), size_);
+  size_ = 0;
+  if (!*out_)
+  {
+    throw std::runtime_error("Failed to write SVG");
+  }
+}
@@ -0,0 +1,57 @@
+#ifndef A4_SVG_WRITER_HPP
+#define A4_SVG_WRITER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+#include "shape.hpp"
+#include "base-types.hpp"
+#include "composite-shape.hpp"
+#include "matrix.hpp"
+
+namespace golovin
+{
+  //Writes SVG documents through one buffer that is kept between calls. Coordinates keep six decimal places
+  //and the y axis points up, as in the shapes themselves; every MatrixShape layer becomes its own group.
+  class SvgWriter
+  {
+  public:
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 20;
+
+    explicit SvgWriter(size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    void write(std::ostream &, const CompositeShape &);
+
+    void write(std::ostream &, const MatrixShape &);
+
+  private:
+    std::vector<char> buffer_;
+    size_t size_;
+    std::ostream *out_;
+
+    void writeShape(const Shape &);
+
+    void writeRectangle(const point_t &center, double width, double height, double angle);
+
+    void writeCircle(const point_t &center, double radius);
+
+    void writePoints(const point_t &point);
+
+    void writeHeader(const rectangle_t &frame);
+
+    void writeFooter();
+
+    void append(const char *text);
+
+    void append(const char *text, size_t size);
+
+    void append(double value);
+
+    //Integers skip the fixed-point formatting, so an index never picks up a fraction or the exponent form.
+    void append(size_t value);
+
+    void flush();
+  };
+}
+
+#endif //A4_SVG_WRITER_HPP
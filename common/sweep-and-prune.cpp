@@ -0,0 +1,224 @@
+#include "sweep-and-prune.hpp"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+golovin::SweepAndPrune::SweepAndPrune() noexcept:
+  bottom_(0.0),
+  bandHeight_(0.0),
+  marginX_(0.0),
+  marginY_(0.0),
+  bandCount_(1),
+  swapCount_(0)
+{
+}
+
+void golovin::SweepAndPrune::update(const CompositeShape &composite, std::vector<pair_t> &result)
+{
+  const size_t size = composite.getSize();
+  frames_.resize(size);
+  for (size_t i = 0; i < size; ++i)
+  {
+    try
+    {
+      frames_[i] = composite[i]->getFrameRect();
+    }
+    catch (const std::exception &e)
+    {
+      std::throw_with_nested(std::logic_error("Failed to perform operation for shape at index " + std::to_string(i)));
+    }
+  }
+  update(frames_, result);
+}
+
+void golovin::SweepAndPrune::update(const std::vector<rectangle_t> &frames, std::vector<pair_t> &result,
+    ThreadPool *pool)
+{
+  result.clear();
+  const size_t size = frames.size();
+  //The pruning bounds are widened by a few ulps so that rounding in them never hides a pair that
+  //isOverlapped() reports.
+  const double epsilon = 4 * std::numeric_limits<double>::epsilon();
+  bounds_.resize(size);
+  marginX_ = 0.0;
+  marginY_ = 0.0;
+  for (size_t i = 0; i < size; ++i)
+  {
+    const rectangle_t &frame = frames[i];
+    const double slackX = epsilon * (std::fabs(frame.pos.x) + frame.width);
+    const double slackY = epsilon * (std::fabs(frame.pos.y) + frame.height);
+    marginX_ = std::max(marginX_, 8.0 * slackX);
+    marginY_ = std::max(marginY_, 8.0 * slackY);
+    bounds_[i] = {frame.pos.x - frame.width / 2.0 - slackX, frame.pos.x + frame.width / 2.0 + slackX,
+        frame.pos.y - frame.height / 2.0 - slackY, frame.pos.y + frame.height / 2.0 + slackY};
+  }
+  if (order_.size() != size)
+  {
+    order_.resize(size);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(), [this](size_t lhs, size_t rhs)
+    {
+      return (bounds_[lhs].minX < bounds_[rhs].minX) || ((bounds_[lhs].minX == bounds_[rhs].minX) && (lhs < rhs));
+    });
+    swapCount_ = 0;
+  }
+  else
+  {
+    sortOrder();
+  }
+  if (size < 2)
+  {
+    return;
+  }
+  double bottom = bounds_.front().minY;
+  double top = bounds_.front().maxY;
+  double heightSum = 0.0;
+  for (size_t i = 0; i < size; ++i)
+  {
+    bottom = std::min(bottom, bounds_[i].minY);
+    top = std::max(top, bounds_[i].maxY);
+    heightSum += frames[i].height;
+  }
+  const double bandCount = std::min(static_cast<double>(size), (top - bottom) / (2.0 * heightSum / size));
+  bandCount_ = (bandCount < 1.0) ? 1 : static_cast<size_t>(bandCount);
+  bottom_ = bottom;
+  bandHeight_ = (top - bottom) / bandCount_;
+  fillBands();
+  const size_t tasks = pool ? std::min(pool->getThreadCount(), bandCount_) : 1;
+  if (tasks < 2)
+  {
+    sweepBands(frames, 0, bandCount_, result);
+    return;
+  }
+  std::vector<size_t> taskBands(tasks + 1, bandCount_);
+  for (size_t task = 0; task < tasks; ++task)
+  {
+    const size_t items = bandItems_.size() * task / tasks;
+    taskBands[task] = std::upper_bound(bandStarts_.begin(), bandStarts_.end(), items) - bandStarts_.begin() - 1;
+  }
+  std::vector<std::vector<pair_t>> parts(tasks);
+  pool->run(tasks, [this, &frames, &parts, &taskBands](size_t task)
+  {
+    sweepBands(frames, taskBands[task], taskBands[task + 1], parts[task]);
+  });
+  for (const std::vector<pair_t> &part : parts)
+  {
+    result.insert(result.end(), part.begin(), part.end());
+  }
+}
+
+void golovin::SweepAndPrune::clear() noexcept
+{
+  frames_.clear();
+  bounds_.clear();
+  order_.clear();
+  bandStarts_.clear();
+  bandItems_.clear();
+  swapCount_ = 0;
+}
+
+size_t golovin::SweepAndPrune::getSize() const noexcept
+{
+  return order_.size();
+}
+
+size_t golovin::SweepAndPrune::getSwapCount() const noexcept
+{
+  return swapCount_;
+}
+
+void golovin::SweepAndPrune::sortOrder() noexcept
+{
+  swapCount_ = 0;
+  for (size_t i = 1; i < order_.size(); ++i)
+  {
+    const size_t id = order_[i];
+    const double minX = bounds_[id].minX;
+    size_t j = i;
+    while ((j > 0) && (bounds_[order_[j - 1]].minX > minX))
+    {
+      order_[j] = order_[j - 1];
+      --j;
+    }
+    swapCount_ += i - j;
+    order_[j] = id;
+  }
+}
+
+bool golovin::SweepAndPrune::isOverlapped(const rectangle_t &first, const rectangle_t &second) noexcept
+{
+  const double distanceX = std::fabs(first.pos.x - second.pos.x);
+  const double distanceY = std::fabs(first.pos.y - second.pos.y);
+  const double sumWidth = ((first.width + second.width) / 2);
+  const double sumHeight = ((first.height + second.height) / 2);
+  return (distanceX < sumWidth) && (distanceY < sumHeight);
+}
+
+size_t golovin::SweepAndPrune::getBand(double y) const noexcept
+{
+  if (bandCount_ == 1)
+  {
+    return 0;
+  }
+  const double band = (y - bottom_) / bandHeight_;
+  return (band <= 0.0) ? 0 : std::min(bandCount_ - 1, static_cast<size_t>(band));
+}
+
+void golovin::SweepAndPrune::fillBands()
+{
+  bandStarts_.assign(bandCount_ + 1, 0);
+  for (const kernels::bounds_t &bounds : bounds_)
+  {
+    const size_t last = getBand(bounds.maxY);
+    for (size_t band = getBand(bounds.minY); band <= last; ++band)
+    {
+      ++bandStarts_[band + 1];
+    }
+  }
+  std::partial_sum(bandStarts_.begin(), bandStarts_.end(), bandStarts_.begin());
+  bandItems_.resize(bandStarts_.back());
+  std::vector<size_t> positions(bandStarts_.begin(), bandStarts_.end() - 1);
+  for (size_t id : order_)
+  {
+    const size_t last = getBand(bounds_[id].maxY);
+    for (size_t band = getBand(bounds_[id].minY); band <= last; ++band)
+    {
+      bandItems_[positions[band]++] = id;
+    }
+  }
+}
+
+void golovin::SweepAndPrune::sweepBands(const std::vector<rectangle_t> &frames, size_t firstBand, size_t lastBand,
+    std::vector<pair_t> &pairs) const
+{
+  for (size_t band = firstBand; band < lastBand; ++band)
+  {
+    const size_t end = bandStarts_[band + 1];
+    for (size_t i = bandStarts_[band]; i < end; ++i)
+    {
+      const size_t id = bandItems_[i];
+      const kernels::bounds_t &current = bounds_[id];
+      for (size_t j = i + 1; (j < end) && (bounds_[bandItems_[j]].minX <= current.maxX); ++j)
+      {
+        const size_t other = bandItems_[j];
+        const kernels::bounds_t &bounds = bounds_[other];
+        if ((bounds.minY > current.maxY) || (current.minY > bounds.maxY)
+            || (getBand(std::max(current.minY, bounds.minY)) != band))
+        {
+          //A pair that shares several bands is reported only in the one holding the higher of its bottoms.
+          continue;
+        }
+        //Only a pair whose widened bounds barely overlap can be turned down by the exact test.
+        const bool isDeep = (std::min(current.maxX, bounds.maxX) - bounds.minX > marginX_)
+            && (std::min(current.maxY, bounds.maxY) - std::max(current.minY, bounds.minY) > marginY_);
+        if (isDeep || isOverlapped(frames[id], frames[other]))
+        {
+          pairs.push_back({std::min(id, other), std::max(id, other)});
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef A4_SWEEP_AND_PRUNE_HPP
+#define A4_SWEEP_AND_PRUNE_HPP
+
+#include <cstddef>
+#include <vector>
+#include "composite-shape.hpp"
+#include "batch-kernels.hpp"
+#include "thread-pool.hpp"
+
+namespace golovin
+{
+  class SweepAndPrune
+  {
+  public:
+    struct pair_t
+    {
+      size_t first;
+      size_t second;
+    };
+
+    SweepAndPrune() noexcept;
+
+    //Reports index pairs (first < second) of children whose frames overlap. The order along X is
+    //kept between calls, so a scene that moves a little per update is re-sorted in near-linear time;
+    //the sweep itself runs inside horizontal bands about two average frames high.
+    void update(const CompositeShape &, std::vector<pair_t> &result);
+
+    //The same sweep over frames that are already read; with a pool the bands are split between its threads.
+    void update(const std::vector<rectangle_t> &frames, std::vector<pair_t> &result, ThreadPool *pool = nullptr);
+
+    void clear() noexcept;
+
+    size_t getSize() const noexcept;
+
+    size_t getSwapCount() const noexcept;
+
+    //Frames overlap when their interiors do; frames that only touch do not. MatrixShape uses it too.
+    static bool isOverlapped(const rectangle_t &, const rectangle_t &) noexcept;
+
+  private:
+    std::vector<rectangle_t> frames_;
+    std::vector<kernels::bounds_t> bounds_;
+    std::vector<size_t> order_;
+    std::vector<size_t> bandStarts_;
+    std::vector<size_t> bandItems_;
+    double bottom_;
+    double bandHeight_;
+    double marginX_;
+    double marginY_;
+    size_t bandCount_;
+    size_t swapCount_;
+
+    void sortOrder() noexcept;
+
+    size_t getBand(double y) const noexcept;
+
+    void fillBands();
+
+    void sweepBands(const std::vector<rectangle_t> &frames, size_t firstBand, size_t lastBand,
+        std::vector<pair_t> &pairs) const;
+  };
+}
+
+#endif //A4_SWEEP_AND_PRUNE_HPP
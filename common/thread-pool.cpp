@@ -0,0 +1,147 @@
+#include "thread-pool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+//The pool whose task the current thread is running, so a nested run() on it is detected.
+static thread_local const golovin::ThreadPool *activePool = nullptr;
+
+golovin::ThreadPool::ThreadPool():
+  ThreadPool(std::max(1u, std::thread::hardware_concurrency()))
+{}
+
+golovin::ThreadPool::ThreadPool(size_t threads):
+  task_(nullptr),
+  count_(0),
+  next_(0),
+  done_(0),
+  generation_(0),
+  isStopped_(false)
+{
+  if (threads == 0)
+  {
+    throw std::invalid_argument("Thread pool must have at least one thread");
+  }
+  for (size_t i = 1; i < threads; ++i)
+  {
+    workers_.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+golovin::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    isStopped_ = true;
+  }
+  wakeUp_.notify_all();
+  for (std::thread &worker : workers_)
+  {
+    worker.join();
+  }
+}
+
+void golovin::ThreadPool::run(size_t count, const task_t &task)
+{
+  if (activePool == this)
+  {
+    runInline(count, task);
+    return;
+  }
+  std::lock_guard<std::mutex> runLock(runMutex_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_ = &task;
+  count_ = count;
+  next_ = 0;
+  done_ = 0;
+  error_ = nullptr;
+  ++generation_;
+  wakeUp_.notify_all();
+  execute(lock);
+  finished_.wait(lock, [this]()
+  {
+    return done_ == count_;
+  });
+  task_ = nullptr;
+  if (error_)
+  {
+    std::rethrow_exception(error_);
+  }
+}
+
+size_t golovin::ThreadPool::getThreadCount() const noexcept
+{
+  return workers_.size() + 1;
+}
+
+void golovin::ThreadPool::runInline(size_t count, const task_t &task)
+{
+  std::exception_ptr error = nullptr;
+  for (size_t i = 0; i < count; ++i)
+  {
+    try
+    {
+      task(i);
+    }
+    catch (...)
+    {
+      if (!error)
+      {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
+}
+
+void golovin::ThreadPool::work()
+{
+  size_t seenGeneration = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    wakeUp_.wait(lock, [this, seenGeneration]()
+    {
+      return isStopped_ || (generation_ != seenGeneration);
+    });
+    if (isStopped_)
+    {
+      return;
+    }
+    seenGeneration = generation_;
+    execute(lock);
+  }
+}
+
+void golovin::ThreadPool::execute(std::unique_lock<std::mutex> &lock)
+{
+  while (task_ && (next_ < count_))
+  {
+    const size_t index = next_++;
+    const task_t &task = *task_;
+    lock.unlock();
+    std::exception_ptr error = nullptr;
+    const ThreadPool *outerPool = activePool;
+    activePool = this;
+    try
+    {
+      task(index);
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+    activePool = outerPool;
+    lock.lock();
+    if (error && !error_)
+    {
+      error_ = error;
+    }
+    if (++done_ == count_)
+    {
+      finished_.notify_all();
+    }
+  }
+}
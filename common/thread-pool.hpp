@@ -0,0 +1,57 @@
+#ifndef A4_THREAD_POOL_HPP
+#define A4_THREAD_POOL_HPP
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace golovin
+{
+  class ThreadPool
+  {
+  public:
+    typedef std::function<void(size_t)> task_t;
+
+    ThreadPool();
+
+    explicit ThreadPool(size_t threads);
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ~ThreadPool();
+
+    ThreadPool& operator=(const ThreadPool &) = delete;
+
+    //Calls task(0) ... task(count - 1) on the pool threads and the caller, then rethrows the first exception.
+    //A task that calls run() on the same pool gets its tasks run inline on its own thread.
+    void run(size_t count, const task_t &task);
+
+    size_t getThreadCount() const noexcept;
+
+  private:
+    std::vector<std::thread> workers_;
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wakeUp_;
+    std::condition_variable finished_;
+    const task_t *task_;
+    size_t count_;
+    size_t next_;
+    size_t done_;
+    size_t generation_;
+    bool isStopped_;
+    std::exception_ptr error_;
+
+    void runInline(size_t count, const task_t &task);
+
+    void work();
+
+    void execute(std::unique_lock<std::mutex> &lock);
+  };
+}
+
+#endif //A4_THREAD_POOL_HPP
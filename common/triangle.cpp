@@ -87,3 +87,28 @@ void golovin::Triangle::print(std::ostream &out) const
 {
   out << "Triangle ";
 }
+
+std::shared_ptr<golovin::Shape> golovin::Triangle::clone() const
+{
+  return std::make_shared<Triangle>(*this);
+}
+
+bool golovin::Triangle::contains(const point_t &point) const noexcept
+{
+  const double first = (b_.x - a_.x) * (point.y - a_.y) - (b_.y - a_.y) * (point.x - a_.x);
+  const double second = (c_.x - b_.x) * (point.y - b_.y) - (c_.y - b_.y) * (point.x - b_.x);
+  const double third = (a_.x - c_.x) * (point.y - c_.y) - (a_.y - c_.y) * (point.x - c_.x);
+  const bool hasNegative = (first < 0.0) || (second < 0.0) || (third < 0.0);
+  const bool hasPositive = (first > 0.0) || (second > 0.0) || (third > 0.0);
+  return !(hasNegative && hasPositive);
+}
+
+golovin::point_t golovin::Triangle::getVertex(size_t index) const
+{
+  const point_t vertices[] = {a_, b_, c_};
+  if (index >= sizeof(vertices) / sizeof(vertices[0]))
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return vertices[index];
+}
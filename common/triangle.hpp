@@ -24,6 +24,12 @@ namespace golovin {
     void rotate(double) noexcept override;
 
     void print(std::ostream &) const override;
+
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const noexcept override;
+
+    point_t getVertex(size_t index) const;
   private:
     point_t a_;
     point_t b_;
@@ -0,0 +1,259 @@
+#include "variant-composite-shape.hpp"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+  struct AreaVisitor : boost::static_visitor<double>
+  {
+    template <typename T>
+    double operator()(const T &shape) const noexcept
+    {
+      static_assert(noexcept(shape.T::getArea()), "An element's getArea() must not throw");
+      return shape.T::getArea();
+    }
+  };
+
+  struct FrameVisitor : boost::static_visitor<golovin::rectangle_t>
+  {
+    template <typename T>
+    golovin::rectangle_t operator()(const T &shape) const
+    {
+      return shape.T::getFrameRect();
+    }
+  };
+
+  struct ContainsVisitor : boost::static_visitor<bool>
+  {
+    golovin::point_t point;
+
+    template <typename T>
+    bool operator()(const T &shape) const
+    {
+      return shape.T::contains(point);
+    }
+  };
+
+  struct MoveVisitor : boost::static_visitor<>
+  {
+    double dX;
+    double dY;
+
+    template <typename T>
+    void operator()(T &shape) const noexcept
+    {
+      static_assert(noexcept(shape.T::move(dX, dY)), "An element's move(dX, dY) must not throw");
+      shape.T::move(dX, dY);
+    }
+  };
+
+  struct ScaleVisitor : boost::static_visitor<>
+  {
+    golovin::point_t pivot;
+    double coefficient;
+
+    template <typename T>
+    void operator()(T &shape) const
+    {
+      const golovin::point_t pos = shape.T::getPos();
+      shape.T::move((pivot.x - pos.x) * (1.0 - coefficient), (pivot.y - pos.y) * (1.0 - coefficient));
+      shape.T::scale(coefficient);
+    }
+  };
+
+  struct RotateVisitor : boost::static_visitor<>
+  {
+    golovin::point_t pivot;
+    double angle;
+    double cosAngle;
+    double sinAngle;
+
+    template <typename T>
+    void operator()(T &shape) const
+    {
+      const golovin::point_t pos = shape.T::getPos();
+      const double dX = pos.x - pivot.x;
+      const double dY = pos.y - pivot.y;
+      shape.T::move(pivot.x + dX * cosAngle - dY * sinAngle - pos.x, pivot.y + dY * cosAngle + dX * sinAngle - pos.y);
+      shape.T::rotate(angle);
+    }
+  };
+}
+
+golovin::VariantCompositeShape::element_t& golovin::VariantCompositeShape::operator[](size_t index)
+{
+  if (index >= elements_.size())
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return elements_[index];
+}
+
+const golovin::VariantCompositeShape::element_t& golovin::VariantCompositeShape::operator[](size_t index) const
+{
+  if (index >= elements_.size())
+  {
+    throw std::out_of_range("Index is out of range");
+  }
+  return elements_[index];
+}
+
+void golovin::VariantCompositeShape::pushBack(const element_t &newElement)
+{
+  elements_.push_back(newElement);
+}
+
+void golovin::VariantCompositeShape::pushBack(element_t &&newElement)
+{
+  elements_.push_back(std::move(newElement));
+}
+
+void golovin::VariantCompositeShape::popBack()
+{
+  if (elements_.empty())
+  {
+    throw std::logic_error("Array is empty");
+  }
+  elements_.pop_back();
+}
+
+void golovin::VariantCompositeShape::reserve(size_t capacity)
+{
+  elements_.reserve(capacity);
+}
+
+double golovin::VariantCompositeShape::getArea() const noexcept
+{
+  const AreaVisitor visitor;
+  double sum = 0.0;
+  for (const element_t &element : elements_)
+  {
+    sum += boost::apply_visitor(visitor, element);
+  }
+  return sum;
+}
+
+golovin::rectangle_t golovin::VariantCompositeShape::getFrameRect() const
+{
+  rectangle_t frame{};
+  if (!tryGetFrameRect(frame))
+  {
+    throw std::logic_error("Array is empty");
+  }
+  return frame;
+}
+
+bool golovin::VariantCompositeShape::tryGetFrameRect(rectangle_t &frame) const
+{
+  if (elements_.empty())
+  {
+    return false;
+  }
+  const FrameVisitor visitor;
+  const rectangle_t rectangle = boost::apply_visitor(visitor, elements_.front());
+  double minX = rectangle.pos.x - rectangle.width / 2.0;
+  double maxX = rectangle.pos.x + rectangle.width / 2.0;
+  double minY = rectangle.pos.y - rectangle.height / 2.0;
+  double maxY = rectangle.pos.y + rectangle.height / 2.0;
+  for (size_t i = 1; i < elements_.size(); ++i)
+  {
+    const rectangle_t curr = boost::apply_visitor(visitor, elements_[i]);
+    minX = std::min(minX, curr.pos.x - curr.width / 2.0);
+    maxX = std::max(maxX, curr.pos.x + curr.width / 2.0);
+    minY = std::min(minY, curr.pos.y - curr.height / 2.0);
+    maxY = std::max(maxY, curr.pos.y + curr.height / 2.0);
+  }
+  frame = {maxX - minX, maxY - minY, {(maxX + minX) / 2.0, (maxY + minY) / 2.0}};
+  return true;
+}
+
+void golovin::VariantCompositeShape::scale(double coefficient)
+{
+  if (coefficient <= 0.0)
+  {
+    throw std::invalid_argument("Scaling coefficient is not positive");
+  }
+  if (elements_.empty())
+  {
+    return;
+  }
+  ScaleVisitor visitor;
+  visitor.pivot = getPos();
+  visitor.coefficient = coefficient;
+  for (element_t &element : elements_)
+  {
+    boost::apply_visitor(visitor, element);
+  }
+}
+
+void golovin::VariantCompositeShape::move(const point_t &destinationPoint)
+{
+  const point_t center = getPos();
+  move(destinationPoint.x - center.x, destinationPoint.y - center.y);
+}
+
+void golovin::VariantCompositeShape::move(double dX, double dY) noexcept
+{
+  MoveVisitor visitor;
+  visitor.dX = dX;
+  visitor.dY = dY;
+  for (element_t &element : elements_)
+  {
+    boost::apply_visitor(visitor, element);
+  }
+}
+
+bool golovin::VariantCompositeShape::isEmpty() const noexcept
+{
+  return elements_.empty();
+}
+
+golovin::point_t golovin::VariantCompositeShape::getPos() const
+{
+  return getFrameRect().pos;
+}
+
+size_t golovin::VariantCompositeShape::getSize() const noexcept
+{
+  return elements_.size();
+}
+
+void golovin::VariantCompositeShape::rotate(double angle)
+{
+  const double PI_IN_DEGREES = 180.0;
+  const double angleRadian = angle * (M_PI / PI_IN_DEGREES);
+  RotateVisitor visitor;
+  visitor.pivot = getPos();
+  visitor.angle = angle;
+  visitor.cosAngle = std::cos(angleRadian);
+  visitor.sinAngle = std::sin(angleRadian);
+  for (element_t &element : elements_)
+  {
+    boost::apply_visitor(visitor, element);
+  }
+}
+
+void golovin::VariantCompositeShape::print(std::ostream &out) const
+{
+  out << "VariantCompositeShape ";
+}
+
+std::shared_ptr<golovin::Shape> golovin::VariantCompositeShape::clone() const
+{
+  return std::make_shared<VariantCompositeShape>(*this);
+}
+
+bool golovin::VariantCompositeShape::contains(const point_t &point) const
+{
+  ContainsVisitor visitor;
+  visitor.point = point;
+  for (const element_t &element : elements_)
+  {
+    if (boost::apply_visitor(visitor, element))
+    {
+      return true;
+    }
+  }
+  return false;
+}
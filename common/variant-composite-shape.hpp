@@ -0,0 +1,65 @@
+#ifndef A4_VARIANT_COMPOSITE_SHAPE_HPP
+#define A4_VARIANT_COMPOSITE_SHAPE_HPP
+
+#include <vector>
+#include <boost/variant.hpp>
+#include "shape.hpp"
+#include "base-types.hpp"
+#include "rectangle.hpp"
+#include "circle.hpp"
+#include "triangle.hpp"
+#include "polygon.hpp"
+
+namespace golovin
+{
+  class VariantCompositeShape : public Shape
+  {
+  public:
+    typedef boost::variant<Rectangle, Circle, Triangle, Polygon> element_t;
+
+    VariantCompositeShape() = default;
+
+    element_t& operator[](size_t);
+
+    const element_t& operator[](size_t) const;
+
+    void pushBack(const element_t &);
+
+    void pushBack(element_t &&);
+
+    void popBack();
+
+    void reserve(size_t capacity);
+
+    double getArea() const noexcept override;
+
+    rectangle_t getFrameRect() const override;
+
+    bool tryGetFrameRect(rectangle_t &) const override;
+
+    void scale(double) override;
+
+    void move(const point_t &) override;
+
+    void move(double dX, double dY) noexcept override;
+
+    bool isEmpty() const noexcept;
+
+    point_t getPos() const override;
+
+    size_t getSize() const noexcept;
+
+    void rotate(double) override;
+
+    void print(std::ostream &) const override;
+
+    std::shared_ptr<Shape> clone() const override;
+
+    bool contains(const point_t &) const override;
+
+  private:
+    std::vector<element_t> elements_;
+  };
+}
+
+#endif //A4_VARIANT_COMPOSITE_SHAPE_HPP
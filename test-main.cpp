@@ -2,14 +2,36 @@
 #define BOOST_TEST_DYN_LINK
 #include <stdexcept>
 #include <cmath>
+#include <random>
+#include <cstdint>
+#include <cfloat>
+#include <thread>
+#include <set>
+#include <algorithm>
+#include <sstream>
+#include <fstream>
+#include <locale>
 #include <boost/test/included/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
+#include <boost/filesystem.hpp>
 #include "common/rectangle.hpp"
 #include "common/circle.hpp"
 #include "common/triangle.hpp"
 #include "common/composite-shape.hpp"
 #include "common/polygon.hpp"
 #include "common/matrix.hpp"
+#include "common/circle-batch.hpp"
+#include "common/rectangle-batch.hpp"
+#include "common/variant-composite-shape.hpp"
+#include "common/arena.hpp"
+#include "common/bounding-hierarchy.hpp"
+#include "common/composite-snapshot.hpp"
+#include "common/concurrent-composite-shape.hpp"
+#include "common/sweep-and-prune.hpp"
+#include "common/scene-format.hpp"
+#include "common/scene-view.hpp"
+#include "common/scene-text.hpp"
+#include "common/svg-writer.hpp"
 
 const double ACCURACY = 1e-8;
 
@@ -190,6 +212,43 @@ BOOST_AUTO_TEST_SUITE(TestRectangle)
     BOOST_CHECK_CLOSE(rectangle.getPos().y, basePoint.y, ACCURACY);
   }
 
+  BOOST_AUTO_TEST_CASE(TestContainsAfterRotate)
+  {
+    golovin::Rectangle rectangle({0.0, 0.0}, 10.0, 2.0);
+
+    BOOST_CHECK(rectangle.contains({5.0, 1.0}));
+    BOOST_CHECK(!rectangle.contains({0.0, 4.0}));
+    rectangle.rotate(90);
+    BOOST_CHECK(rectangle.contains({0.0, 4.0}));
+    BOOST_CHECK(!rectangle.contains({4.0, 0.0}));
+    rectangle.rotate(-45);
+    BOOST_CHECK(rectangle.contains({3.0, 3.0}));
+    BOOST_CHECK(!rectangle.contains({4.0, 0.0}));
+    BOOST_CHECK(rectangle.getFrameRect().width / 2.0 > 4.0);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestFrameAfterRotationSequence)
+  {
+    const double PI_IN_DEGREES = 180.0;
+    const double angle = 30.0;
+    const double width = 6.0;
+    const double height = 2.0;
+    golovin::Rectangle rectangle({1.0, -2.0}, width, height);
+    for (int i = 1; i <= 12; ++i)
+    {
+      rectangle.rotate(angle);
+      const double angleRadian = std::fmod(i * angle, 360.0) * (M_PI / PI_IN_DEGREES);
+      const golovin::rectangle_t frame = rectangle.getFrameRect();
+      BOOST_CHECK_CLOSE(frame.width, width * std::fabs(std::cos(angleRadian)) + height * std::fabs(std::sin(angleRadian)),
+          ACCURACY);
+      BOOST_CHECK_CLOSE(frame.height, width * std::fabs(std::sin(angleRadian)) + height * std::fabs(std::cos(angleRadian)),
+          ACCURACY);
+      BOOST_CHECK_EQUAL(rectangle.getPos().x, 1.0);
+      BOOST_CHECK_EQUAL(rectangle.getPos().y, -2.0);
+    }
+    BOOST_CHECK_CLOSE(rectangle.getAngle() + 1.0, 1.0, ACCURACY);
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(TestCircle)
@@ -350,6 +409,15 @@ BOOST_AUTO_TEST_SUITE(TestCircle)
     BOOST_CHECK_CLOSE(circle.getPos().y, basePoint.y, ACCURACY);
   }
 
+  BOOST_AUTO_TEST_CASE(TestContains)
+  {
+    const golovin::Circle circle({1.0, 1.0}, 2.0);
+
+    BOOST_CHECK(circle.contains({1.0, 1.0}));
+    BOOST_CHECK(circle.contains({3.0, 1.0}));
+    BOOST_CHECK(!circle.contains({2.5, 2.5}));
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(TestTriangle)
@@ -525,6 +593,18 @@ BOOST_AUTO_TEST_SUITE(TestTriangle)
     BOOST_CHECK_CLOSE(triangle.getFrameRect().width, height, ACCURACY);
   }
 
+  BOOST_AUTO_TEST_CASE(TestContains)
+  {
+    const golovin::Triangle triangle({0.0, 0.0}, {4.0, 0.0}, {0.0, 4.0});
+    const golovin::Triangle reversed({0.0, 0.0}, {0.0, 4.0}, {4.0, 0.0});
+
+    BOOST_CHECK(triangle.contains({1.0, 1.0}));
+    BOOST_CHECK(triangle.contains({2.0, 2.0}));
+    BOOST_CHECK(!triangle.contains({3.0, 3.0}));
+    BOOST_CHECK(reversed.contains({1.0, 1.0}));
+    BOOST_CHECK(!reversed.contains({-1.0, 1.0}));
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(CompositeShapeTest)
@@ -1043,6 +1123,394 @@ BOOST_AUTO_TEST_SUITE(CompositeShapeTest)
     BOOST_CHECK_CLOSE(compositeShape.getFrameRect().width, heightOfShape, ACCURACY);
   }
 
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeCenterAfterScale)
+  {
+    golovin::CompositeShape compositeShape;
+    compositeShape.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 1.0}, 2.0, 4.0));
+    compositeShape.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{5.0, 3.0}, 1.0));
+    const golovin::rectangle_t frame = compositeShape.getFrameRect();
+    compositeShape.scale(3.0);
+
+    BOOST_CHECK_CLOSE(compositeShape.getFrameRect().pos.x, frame.pos.x, ACCURACY);
+    BOOST_CHECK_CLOSE(compositeShape.getFrameRect().pos.y, frame.pos.y, ACCURACY);
+    BOOST_CHECK_CLOSE(compositeShape.getFrameRect().width, frame.width * 3.0, ACCURACY);
+    BOOST_CHECK_CLOSE(compositeShape.getFrameRect().height, frame.height * 3.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeFrameAfterChildChanges)
+  {
+    golovin::CompositeShape::shapePointer circle = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape compositeShape;
+    compositeShape.pushBack(circle);
+    BOOST_CHECK_CLOSE(compositeShape.getFrameRect().width, 2.0, ACCURACY);
+
+    compositeShape[0]->scale(2.0);
+    BOOST_CHECK_CLOSE(compositeShape.getFrameRect().width, 4.0, ACCURACY);
+
+    circle->move({3.0, 0.0});
+    BOOST_CHECK_CLOSE(compositeShape.getPos().x, 3.0, ACCURACY);
+
+    compositeShape.move(1.0, 1.0);
+    BOOST_CHECK_CLOSE(compositeShape.getPos().x, 4.0, ACCURACY);
+    BOOST_CHECK_CLOSE(compositeShape.getPos().y, 1.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeFrameSeesAliasedChanges)
+  {
+    golovin::CompositeShape::shapePointer circle = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer rectangle = std::make_shared<golovin::Rectangle>(golovin::point_t{5.0, 0.0},
+        2.0, 2.0);
+    std::shared_ptr<golovin::CompositeShape> inner = std::make_shared<golovin::CompositeShape>();
+    inner->pushBack(rectangle);
+    golovin::CompositeShape composite;
+    composite.pushBack(circle);
+    composite.pushBack(inner);
+    BOOST_CHECK_CLOSE(composite.getFrameRect().width, 7.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite.getPos().x, 2.5, ACCURACY);
+
+    circle->move(100.0, 0.0);
+    BOOST_CHECK_CLOSE(composite.getFrameRect().width, 97.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite.getPos().x, 52.5, ACCURACY);
+
+    rectangle->move(200.0, 0.0);
+    BOOST_CHECK_CLOSE(composite.getFrameRect().width, 107.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite.getPos().x, 152.5, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeDeferredTransforms)
+  {
+    golovin::CompositeShape::shapePointer rectangle =
+        std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 1.0}, 2.0, 4.0);
+    golovin::CompositeShape::shapePointer triangle =
+        std::make_shared<golovin::Triangle>(golovin::point_t{3.0, 0.0}, golovin::point_t{4.0, 2.0}, golovin::point_t{6.0, 1.0});
+    golovin::CompositeShape eager;
+    eager.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 1.0}, 2.0, 4.0));
+    eager.pushBack(std::make_shared<golovin::Triangle>(golovin::point_t{3.0, 0.0}, golovin::point_t{4.0, 2.0},
+        golovin::point_t{6.0, 1.0}));
+    golovin::CompositeShape deferred;
+    deferred.pushBack(rectangle);
+    deferred.pushBack(triangle);
+    deferred.setDeferred(true);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+      eager.move(1.0, -2.0);
+      eager.scale(1.5);
+      eager.rotate(90);
+      eager.move({3.0, 4.0});
+      deferred.move(1.0, -2.0);
+      deferred.scale(1.5);
+      deferred.rotate(90);
+      deferred.move({3.0, 4.0});
+    }
+    BOOST_CHECK_CLOSE(rectangle->getPos().x, 1.0, ACCURACY);
+    BOOST_CHECK_CLOSE(rectangle->getArea(), 8.0, ACCURACY);
+
+    BOOST_CHECK_CLOSE(deferred.getArea(), eager.getArea(), ACCURACY);
+    BOOST_CHECK_CLOSE(deferred.getFrameRect().pos.x, eager.getFrameRect().pos.x, ACCURACY);
+    BOOST_CHECK_CLOSE(deferred.getFrameRect().pos.y, eager.getFrameRect().pos.y, ACCURACY);
+    BOOST_CHECK_CLOSE(deferred.getFrameRect().width, eager.getFrameRect().width, ACCURACY);
+    BOOST_CHECK_CLOSE(deferred.getFrameRect().height, eager.getFrameRect().height, ACCURACY);
+    BOOST_CHECK_CLOSE(deferred[1]->getPos().x, eager[1]->getPos().x, ACCURACY);
+    BOOST_CHECK_CLOSE(deferred[1]->getPos().y, eager[1]->getPos().y, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeDeferredObliqueRotation)
+  {
+    const double TOLERANCE = 1e-9;
+    golovin::CompositeShape eager;
+    golovin::CompositeShape deferred;
+    deferred.setDeferred(true);
+    for (golovin::CompositeShape *composite : {&eager, &deferred})
+    {
+      composite->pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 1.0}, 2.0, 4.0));
+      composite->pushBack(std::make_shared<golovin::Circle>(golovin::point_t{5.0, -1.0}, 1.5));
+      composite->pushBack(std::make_shared<golovin::Triangle>(golovin::point_t{3.0, 0.0}, golovin::point_t{4.0, 2.0},
+          golovin::point_t{6.0, 1.0}));
+      composite->rotate(30);
+      composite->scale(2.0);
+      composite->rotate(30);
+      composite->move({0.0, 0.0});
+    }
+
+    BOOST_CHECK_SMALL(eager.getFrameRect().pos.x, TOLERANCE);
+    BOOST_CHECK_SMALL(eager.getFrameRect().pos.y, TOLERANCE);
+    BOOST_CHECK_SMALL(deferred.getFrameRect().pos.x, TOLERANCE);
+    BOOST_CHECK_SMALL(deferred.getFrameRect().pos.y, TOLERANCE);
+    BOOST_CHECK_CLOSE(deferred.getFrameRect().width, eager.getFrameRect().width, ACCURACY);
+    for (size_t i = 0; i < eager.getSize(); ++i)
+    {
+      BOOST_CHECK_SMALL(deferred[i]->getPos().x - eager[i]->getPos().x, TOLERANCE);
+      BOOST_CHECK_SMALL(deferred[i]->getPos().y - eager[i]->getPos().y, TOLERANCE);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeDeferredPivotAfterChildChanges)
+  {
+    golovin::CompositeShape::shapePointer circle = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape composite;
+    composite.setDeferred(true);
+    composite.pushBack(circle);
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{4.0, 0.0}, 1.0));
+    composite.scale(2.0);
+    circle->move({-4.0, 0.0});
+    composite.rotate(180.0);
+
+    BOOST_CHECK_CLOSE(composite[0]->getPos().x, 6.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite[1]->getPos().x, -10.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite.getPos().x, -2.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeFailedFlushKeepsPendingTransform)
+  {
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    nested->pushBack(std::make_shared<golovin::Circle>(golovin::point_t{4.0, 0.0}, 1.0));
+    golovin::CompositeShape composite;
+    composite.setDeferred(true);
+    composite.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{0.0, 0.0}, 2.0, 2.0));
+    composite.pushBack(nested);
+    composite.rotate(90.0);
+    nested->popBack();
+
+    BOOST_CHECK_THROW(composite.getArea(), std::logic_error);
+    nested->pushBack(std::make_shared<golovin::Circle>(golovin::point_t{4.0, 0.0}, 1.0));
+    BOOST_CHECK_CLOSE(composite.getArea(), 4.0 + M_PI, ACCURACY);
+    BOOST_CHECK_CLOSE(composite[0]->getPos().x, 2.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite[0]->getPos().y, -2.0, ACCURACY);
+    BOOST_CHECK_CLOSE(nested->getPos().x, 2.0, ACCURACY);
+    BOOST_CHECK_CLOSE(nested->getPos().y, 2.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeFlushOnLeavingDeferredMode)
+  {
+    golovin::CompositeShape::shapePointer circle = std::make_shared<golovin::Circle>(golovin::point_t{1.0, 1.0}, 1.0);
+    golovin::CompositeShape compositeShape;
+    compositeShape.pushBack(circle);
+    compositeShape.setDeferred(true);
+    compositeShape.move(2.0, 3.0);
+    compositeShape.scale(2.0);
+    BOOST_CHECK(compositeShape.isDeferred());
+    BOOST_CHECK_CLOSE(circle->getPos().x, 1.0, ACCURACY);
+
+    compositeShape.setDeferred(false);
+    BOOST_CHECK_CLOSE(circle->getPos().x, 3.0, ACCURACY);
+    BOOST_CHECK_CLOSE(circle->getPos().y, 4.0, ACCURACY);
+    BOOST_CHECK_CLOSE(circle->getArea(), 4.0 * M_PI, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeReuseAfterMove)
+  {
+    golovin::CompositeShape composite;
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    golovin::CompositeShape moved(std::move(composite));
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{1.0, 1.0}, 2.0));
+
+    BOOST_CHECK_EQUAL(composite.getSize(), 1);
+    BOOST_CHECK_EQUAL(moved.getSize(), 1);
+    BOOST_CHECK_CLOSE(composite.getArea(), 4.0 * M_PI, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeParallelReductions)
+  {
+    std::mt19937 generator(13);
+    std::uniform_real_distribution<double> position(-100.0, 100.0);
+    std::uniform_real_distribution<double> side(0.1, 3.0);
+    golovin::CompositeShape composite;
+    for (size_t i = 0; i < 5000; ++i)
+    {
+      composite.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{position(generator), position(generator)},
+          side(generator), side(generator)));
+    }
+    golovin::ThreadPool pool(3);
+    const double area = composite.getArea();
+    const double parallelArea = composite.getArea(pool, 64);
+    const golovin::rectangle_t parallelFrame = composite.getFrameRect(pool, 64);
+    const golovin::rectangle_t frame = composite.getFrameRect();
+
+    BOOST_CHECK(std::fabs(parallelArea - area) <= 2.0 * composite.getSize() * DBL_EPSILON * area);
+    BOOST_CHECK_EQUAL(parallelFrame.width, frame.width);
+    BOOST_CHECK_EQUAL(parallelFrame.height, frame.height);
+    BOOST_CHECK_EQUAL(parallelFrame.pos.x, frame.pos.x);
+    BOOST_CHECK_EQUAL(parallelFrame.pos.y, frame.pos.y);
+    BOOST_CHECK_EQUAL(composite.getArea(pool, 10000), area);
+    BOOST_CHECK_THROW(composite.getArea(pool, 0), std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeParallelReadFlushesNestedComposites)
+  {
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    nested->setDeferred(true);
+    nested->pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    nested->pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{4.0, 0.0}, 2.0, 2.0));
+    golovin::CompositeShape composite;
+    composite.pushBack(nested);
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 10.0}, 1.0));
+    composite.pushBack(nested);
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, -10.0}, 1.0));
+    nested->scale(2.0);
+    golovin::ThreadPool pool(4);
+    const double area = composite.getArea(pool, 1);
+    const golovin::CompositeShape &view = *nested;
+
+    BOOST_CHECK_CLOSE(view.getUnchecked(0)->getArea(), 4.0 * M_PI, ACCURACY);
+    BOOST_CHECK_CLOSE(area, 2.0 * (4.0 * M_PI + 16.0) + 2.0 * M_PI, ACCURACY);
+    BOOST_CHECK_CLOSE(composite.getFrameRect(pool, 1).width, 12.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeParallelFrameErrors)
+  {
+    golovin::CompositeShape composite;
+    golovin::ThreadPool pool(2);
+    BOOST_CHECK_THROW(composite.getFrameRect(pool, 1), std::logic_error);
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    composite.pushBack(std::make_shared<golovin::CompositeShape>());
+
+    BOOST_CHECK_THROW(composite.getFrameRect(pool, 1), std::logic_error);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeInsertionApi)
+  {
+    golovin::CompositeShape composite;
+    composite.reserve(16);
+    golovin::CompositeShape::shapePointer circle = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    const golovin::Shape *circleAddress = circle.get();
+    composite.pushBack(std::move(circle));
+    golovin::Rectangle &rectangle = composite.emplaceBack<golovin::Rectangle>(golovin::point_t{4.0, 0.0}, 2.0, 2.0);
+    std::vector<golovin::CompositeShape::shapePointer> shapes{
+        std::make_shared<golovin::Circle>(golovin::point_t{0.0, 4.0}, 1.0),
+        std::make_shared<golovin::Circle>(golovin::point_t{4.0, 4.0}, 1.0)};
+    composite.append(shapes.begin(), shapes.end());
+
+    BOOST_CHECK(!circle);
+    BOOST_CHECK_EQUAL(composite[0].get(), circleAddress);
+    BOOST_CHECK_EQUAL(composite[0].use_count(), 1);
+    BOOST_CHECK_EQUAL(composite[1].get(), &rectangle);
+    BOOST_CHECK_EQUAL(composite.getSize(), 4);
+    BOOST_CHECK_EQUAL(composite.getCapacity(), 16);
+    BOOST_CHECK_CLOSE(composite.getArea(), 3.0 * M_PI + 4.0, ACCURACY);
+
+    const golovin::CompositeShape copy(composite);
+    BOOST_CHECK_EQUAL(copy.getCapacity(), 16);
+    composite.shrinkToFit();
+    BOOST_CHECK_EQUAL(composite.getCapacity(), 4);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeAppendRejectsNull)
+  {
+    golovin::CompositeShape composite;
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    const std::vector<golovin::CompositeShape::shapePointer> shapes{
+        std::make_shared<golovin::Circle>(golovin::point_t{0.0, 4.0}, 1.0), nullptr};
+
+    BOOST_CHECK_THROW(composite.append(shapes.begin(), shapes.end()), std::invalid_argument);
+    BOOST_CHECK_EQUAL(composite.getSize(), 1);
+    BOOST_CHECK_THROW(composite.pushBack(golovin::CompositeShape::shapePointer()), std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeAppendKeepsMovedSourceOnNull)
+  {
+    golovin::CompositeShape composite;
+    std::vector<golovin::CompositeShape::shapePointer> shapes{
+        std::make_shared<golovin::Circle>(golovin::point_t{0.0, 4.0}, 1.0), nullptr};
+
+    BOOST_CHECK_THROW(composite.append(std::make_move_iterator(shapes.begin()), std::make_move_iterator(shapes.end())),
+        std::invalid_argument);
+    BOOST_CHECK(composite.isEmpty());
+    BOOST_CHECK(shapes[0]);
+
+    shapes[1] = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    composite.append(std::make_move_iterator(shapes.begin()), std::make_move_iterator(shapes.end()));
+    BOOST_CHECK_EQUAL(composite.getSize(), 2);
+    BOOST_CHECK(!shapes[0]);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeCloneIsDeep)
+  {
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    nested->pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    golovin::CompositeShape composite;
+    composite.pushBack(nested);
+    composite.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{4.0, 0.0}, 2.0, 2.0));
+    const std::shared_ptr<golovin::Shape> clone = composite.clone();
+    composite.scale(2.0);
+    nested->move(10.0, 10.0);
+
+    BOOST_CHECK_CLOSE(clone->getArea(), M_PI + 4.0, ACCURACY);
+    BOOST_CHECK_CLOSE(clone->getFrameRect().width, 6.0, ACCURACY);
+    BOOST_CHECK_CLOSE(clone->getFrameRect().pos.x, 2.0, ACCURACY);
+    BOOST_CHECK_CLOSE(clone->getFrameRect().pos.y, 0.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeContains)
+  {
+    golovin::CompositeShape composite;
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    composite.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{10.0, 0.0}, 2.0, 2.0));
+
+    BOOST_CHECK(composite.contains({0.5, 0.5}));
+    BOOST_CHECK(composite.contains({10.5, -0.5}));
+    BOOST_CHECK(!composite.contains({5.0, 0.0}));
+    composite.move(1.0, 0.0);
+    BOOST_CHECK(composite.contains({11.9, 0.0}));
+    BOOST_CHECK(!composite.contains({-0.5, 0.0}));
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeTryFrameRect)
+  {
+    golovin::CompositeShape composite;
+    golovin::rectangle_t frame{1.0, 1.0, {0.0, 0.0}};
+    BOOST_CHECK(!composite.tryGetFrameRect(frame));
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    composite.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{10.0, 0.0}, 2.0, 4.0));
+    BOOST_CHECK(composite.tryGetFrameRect(frame));
+    BOOST_CHECK_CLOSE(frame.width, composite.getFrameRect().width, ACCURACY);
+    BOOST_CHECK_CLOSE(frame.height, composite.getFrameRect().height, ACCURACY);
+    BOOST_CHECK_CLOSE(frame.pos.x, composite.getFrameRect().pos.x, ACCURACY);
+
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    composite.pushBack(nested);
+    BOOST_CHECK(!composite.tryGetFrameRect(frame));
+    BOOST_CHECK(!golovin::CompositeSnapshot(composite).tryGetFrameRect(frame));
+    try
+    {
+      composite.getFrameRect();
+      BOOST_ERROR("getFrameRect() must throw for an empty nested composite");
+    }
+    catch (const std::logic_error &error)
+    {
+      BOOST_CHECK_EQUAL(error.what(), std::string("Failed to perform operation for shape at index 2"));
+    }
+    golovin::ThreadPool pool(2);
+    BOOST_CHECK_THROW(composite.getFrameRect(pool, 1), std::logic_error);
+
+    nested->pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 20.0}, 1.0));
+    BOOST_CHECK(composite.tryGetFrameRect(frame));
+    BOOST_CHECK_CLOSE(frame.height, 23.0, ACCURACY);
+    BOOST_CHECK(golovin::CompositeSnapshot(composite).tryGetFrameRect(frame));
+    BOOST_CHECK_CLOSE(frame.height, 23.0, ACCURACY);
+    BOOST_CHECK(!golovin::CircleBatch().tryGetFrameRect(frame));
+    BOOST_CHECK(!golovin::RectangleBatch().tryGetFrameRect(frame));
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCompositeShapeUncheckedAccess)
+  {
+    golovin::CompositeShape composite;
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{5.0, 0.0}, 2.0));
+
+    const golovin::CompositeShape &view = composite;
+    BOOST_CHECK(view.getUnchecked(1) == view[1]);
+    composite.setDeferred(true);
+    composite.move(1.0, 0.0);
+    BOOST_CHECK_CLOSE(view.getUnchecked(0)->getPos().x + 1.0, 1.0, ACCURACY);
+    BOOST_CHECK_CLOSE(view[0]->getPos().x, 1.0, ACCURACY);
+    BOOST_CHECK_CLOSE(view.getUnchecked(0)->getPos().x, 1.0, ACCURACY);
+    composite.getUnchecked(1) = std::make_shared<golovin::Circle>(golovin::point_t{20.0, 0.0}, 1.0);
+    BOOST_CHECK_CLOSE(composite.getFrameRect().width, 21.0, ACCURACY);
+    composite[1] = std::make_shared<golovin::Circle>(golovin::point_t{30.0, 0.0}, 1.0);
+    BOOST_CHECK_CLOSE(composite.getFrameRect().width, 31.0, ACCURACY);
+  }
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(TestPolygon)
@@ -1260,6 +1728,17 @@ BOOST_AUTO_TEST_SUITE(TestPolygon)
     BOOST_CHECK_CLOSE(polygon.getFrameRect().height, width, ACCURACY);
     BOOST_CHECK_CLOSE(polygon.getFrameRect().width, height, ACCURACY);
   }
+
+  BOOST_AUTO_TEST_CASE(TestContains)
+  {
+    golovin::point_t points[] = {{-1.0, 1.0}, {2.0, 5.0}, {5.0, 4.0}, {4.0, 2.0}};
+    golovin::Polygon polygon(points, 4);
+
+    BOOST_CHECK(polygon.contains(polygon.getPos()));
+    BOOST_CHECK(polygon.contains({-1.0, 1.0}));
+    BOOST_CHECK(!polygon.contains({4.0, 1.0}));
+    BOOST_CHECK(!polygon.contains({0.0, 4.0}));
+  }
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(MatrixShapeTest)
@@ -1401,6 +1880,413 @@ BOOST_AUTO_TEST_SUITE(MatrixShapeTest)
 
     BOOST_CHECK_THROW(matrixShape[10][10], std::out_of_range);
   }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixFirstFreeLayer)
+  {
+    golovin::CompositeShape::shapePointer first = std::make_shared<golovin::Rectangle>(golovin::point_t{0.0, 0.0}, 2.0, 2.0);
+    golovin::CompositeShape::shapePointer second = std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 1.5}, 2.0, 2.0);
+    golovin::CompositeShape::shapePointer third = std::make_shared<golovin::Rectangle>(golovin::point_t{2.5, 0.0}, 2.0, 2.0);
+    golovin::CompositeShape::shapePointer fourth = std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 2.2}, 0.5, 0.5);
+
+    golovin::MatrixShape matrix;
+    matrix.addShape(first);
+    matrix.addShape(second);
+    matrix.addShape(third);
+    matrix.addShape(fourth);
+
+    BOOST_CHECK(matrix[0][0] == first);
+    BOOST_CHECK(matrix[0][1] == third);
+    BOOST_CHECK(matrix[0][2] == fourth);
+    BOOST_CHECK(matrix[1][0] == second);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixIndexedAndBulkLayering)
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> position(0.0, 100.0);
+    std::uniform_real_distribution<double> side(0.5, 8.0);
+    golovin::CompositeShape compositeShape;
+    for (size_t i = 0; i < 500; ++i)
+    {
+      if (i % 2 == 0)
+      {
+        compositeShape.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{position(generator),
+            position(generator)}, side(generator), side(generator)));
+      }
+      else
+      {
+        compositeShape.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{position(generator),
+            position(generator)}, side(generator) / 2.0));
+      }
+    }
+
+    golovin::MatrixShape matrix;
+    golovin::MatrixShape indexedMatrix;
+    indexedMatrix.enableIndex(4.0);
+    for (size_t i = 0; i < compositeShape.getSize(); ++i)
+    {
+      matrix.addShape(compositeShape[i]);
+      indexedMatrix.addShape(compositeShape[i]);
+    }
+    golovin::MatrixShape bulkMatrix(compositeShape);
+
+    BOOST_CHECK(indexedMatrix.isIndexed());
+    BOOST_REQUIRE_EQUAL(matrix.getSize(), indexedMatrix.getSize());
+    BOOST_REQUIRE_EQUAL(matrix.getSize(), bulkMatrix.getSize());
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), indexedMatrix.getLayerCount());
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), bulkMatrix.getLayerCount());
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(matrix[i].getSize(), indexedMatrix[i].getSize());
+      BOOST_REQUIRE_EQUAL(matrix[i].getSize(), bulkMatrix[i].getSize());
+      for (size_t j = 0; j < matrix[i].getSize(); ++j)
+      {
+        BOOST_CHECK(matrix[i][j] == indexedMatrix[i][j]);
+        BOOST_CHECK(matrix[i][j] == bulkMatrix[i][j]);
+      }
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixBulkTouchingShapes)
+  {
+    golovin::CompositeShape compositeShape;
+    for (size_t i = 0; i < 10; ++i)
+    {
+      for (size_t j = 0; j < 10; ++j)
+      {
+        compositeShape.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{0.1 * i, 0.1 * j}, 0.1, 0.1));
+        compositeShape.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{0.1 * i + 0.05, 0.1 * j}, 0.1, 0.1));
+      }
+    }
+
+    golovin::MatrixShape matrix;
+    for (size_t i = 0; i < compositeShape.getSize(); ++i)
+    {
+      matrix.addShape(compositeShape[i]);
+    }
+    golovin::MatrixShape bulkMatrix(compositeShape);
+
+    BOOST_REQUIRE_EQUAL(matrix.getSize(), bulkMatrix.getSize());
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), bulkMatrix.getLayerCount());
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(matrix[i].getSize(), bulkMatrix[i].getSize());
+      for (size_t j = 0; j < matrix[i].getSize(); ++j)
+      {
+        BOOST_CHECK(matrix[i][j] == bulkMatrix[i][j]);
+      }
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixParallelBuild)
+  {
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> position(0.0, 200.0);
+    std::uniform_real_distribution<double> side(0.5, 12.0);
+    golovin::CompositeShape compositeShape;
+    for (size_t i = 0; i < 2000; ++i)
+    {
+      compositeShape.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{position(generator),
+          position(generator)}, side(generator), side(generator)));
+    }
+
+    golovin::ThreadPool pool(4);
+    golovin::MatrixShape matrix(compositeShape);
+    golovin::MatrixShape parallelMatrix(compositeShape, pool);
+
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), parallelMatrix.getLayerCount());
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(matrix[i].getSize(), parallelMatrix[i].getSize());
+      for (size_t j = 0; j < matrix[i].getSize(); ++j)
+      {
+        BOOST_CHECK(matrix[i][j] == parallelMatrix[i][j]);
+      }
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixParallelBuildFromDeferredComposite)
+  {
+    std::mt19937 generator(5);
+    std::uniform_real_distribution<double> position(0.0, 100.0);
+    golovin::CompositeShape eager;
+    golovin::CompositeShape deferred;
+    deferred.setDeferred(true);
+    for (size_t i = 0; i < 1000; ++i)
+    {
+      const golovin::point_t center{position(generator), position(generator)};
+      eager.pushBack(std::make_shared<golovin::Rectangle>(center, 3.0, 2.0));
+      deferred.pushBack(std::make_shared<golovin::Rectangle>(center, 3.0, 2.0));
+    }
+    eager.move(5.0, -5.0);
+    eager.scale(1.5);
+    deferred.move(5.0, -5.0);
+    deferred.scale(1.5);
+
+    golovin::ThreadPool pool(4);
+    const golovin::MatrixShape matrix(eager);
+    const golovin::MatrixShape parallelMatrix(deferred, pool);
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), parallelMatrix.getLayerCount());
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(matrix[i].getSize(), parallelMatrix[i].getSize());
+      for (size_t j = 0; j < matrix[i].getSize(); ++j)
+      {
+        const golovin::rectangle_t expected = matrix[i][j]->getFrameRect();
+        const golovin::rectangle_t actual = parallelMatrix[i][j]->getFrameRect();
+        BOOST_CHECK_CLOSE(actual.pos.x, expected.pos.x, ACCURACY);
+        BOOST_CHECK_CLOSE(actual.pos.y, expected.pos.y, ACCURACY);
+      }
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixRaggedLayers)
+  {
+    golovin::MatrixShape matrix;
+    for (size_t i = 0; i < 4; ++i)
+    {
+      matrix.addShape(std::make_shared<golovin::Circle>(golovin::point_t{10.0 * i, 0.0}, 1.0));
+    }
+    matrix.addShape(std::make_shared<golovin::Circle>(golovin::point_t{0.5, 0.0}, 1.0));
+
+    BOOST_CHECK_EQUAL(matrix.getSize(), 8);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK_EQUAL(matrix.getLayer(1).getSize(), 4);
+    BOOST_CHECK(matrix.getLayer(1)[0] != nullptr);
+    BOOST_CHECK(matrix.getLayer(1)[1] == nullptr);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixLayerView)
+  {
+    golovin::MatrixShape matrix;
+    for (size_t i = 0; i < 4; ++i)
+    {
+      matrix.addShape(std::make_shared<golovin::Circle>(golovin::point_t{10.0 * i, 0.0}, 1.0));
+    }
+    golovin::CompositeShape::shapePointer circle = std::make_shared<golovin::Circle>(golovin::point_t{0.5, 0.0}, 1.0);
+    matrix.addShape(circle);
+
+    const golovin::LayerView layer = matrix[1];
+    BOOST_CHECK_EQUAL(layer.getSize(), 1);
+    BOOST_CHECK(layer[0] == circle);
+    BOOST_CHECK(layer.getUnchecked(0) == circle);
+    BOOST_CHECK_EQUAL(matrix.getUnchecked(1).getSize(), 1);
+    BOOST_CHECK(matrix.getLayer(1).getUnchecked(0) == circle);
+    BOOST_CHECK_EQUAL(circle.use_count(), 2);
+    BOOST_CHECK_THROW(layer[1], std::out_of_range);
+    size_t count = 0;
+    for (const golovin::CompositeShape::shapePointer &shape : matrix[0])
+    {
+      BOOST_CHECK(shape != nullptr);
+      ++count;
+    }
+    BOOST_CHECK_EQUAL(count, 4);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixUpdateAfterMoving)
+  {
+    golovin::CompositeShape::shapePointer first = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer second = std::make_shared<golovin::Circle>(golovin::point_t{0.5, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer third = std::make_shared<golovin::Circle>(golovin::point_t{10.0, 0.0}, 1.0);
+    golovin::MatrixShape matrix;
+    matrix.enableIndex(2.0);
+    matrix.addShape(first);
+    matrix.addShape(second);
+    matrix.addShape(third);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 2);
+
+    second->move({20.0, 0.0});
+    matrix.markChanged(second);
+    matrix.update();
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 1);
+    BOOST_CHECK_EQUAL(matrix[0].getSize(), 3);
+
+    third->move({0.0, 0.5});
+    matrix.markChanged(third);
+    matrix.update();
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK(matrix[1][0] == third);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixCachedFramesRefreshOnUpdate)
+  {
+    golovin::CompositeShape::shapePointer first = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer second = std::make_shared<golovin::Circle>(golovin::point_t{5.0, 0.0}, 1.0);
+    golovin::MatrixShape matrix;
+    matrix.enableIndex(2.0);
+    matrix.addShape(first);
+    first->move({5.0, 0.0});
+    matrix.addShape(second);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 1);
+
+    matrix.markChanged(first);
+    matrix.update();
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK(matrix[0][0] == second);
+    BOOST_CHECK(matrix[1][0] == first);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixUpdateKeepsLayersValid)
+  {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> position(0.0, 50.0);
+    std::uniform_real_distribution<double> offset(-5.0, 5.0);
+    golovin::CompositeShape compositeShape;
+    for (size_t i = 0; i < 300; ++i)
+    {
+      compositeShape.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{position(generator),
+          position(generator)}, 3.0, 2.0));
+    }
+    golovin::MatrixShape matrix(compositeShape, 4.0);
+    for (size_t i = 0; i < compositeShape.getSize(); i += 7)
+    {
+      compositeShape[i]->move(offset(generator), offset(generator));
+      compositeShape[i]->rotate(30);
+      matrix.markChanged(compositeShape[i]);
+    }
+    matrix.update();
+
+    size_t count = 0;
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      const golovin::LayerView layer = matrix[i];
+      count += layer.getSize();
+      for (size_t j = 0; j < layer.getSize(); ++j)
+      {
+        for (size_t k = j + 1; k < layer.getSize(); ++k)
+        {
+          const golovin::rectangle_t lhs = layer[j]->getFrameRect();
+          const golovin::rectangle_t rhs = layer[k]->getFrameRect();
+          BOOST_CHECK(!((std::fabs(lhs.pos.x - rhs.pos.x) < (lhs.width + rhs.width) / 2)
+              && (std::fabs(lhs.pos.y - rhs.pos.y) < (lhs.height + rhs.height) / 2)));
+        }
+      }
+    }
+    BOOST_CHECK_EQUAL(count, compositeShape.getSize());
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixUpdateKeepsOrderAndCompacts)
+  {
+    std::vector<golovin::CompositeShape::shapePointer> shapes;
+    for (size_t i = 0; i < 3; ++i)
+    {
+      shapes.push_back(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    }
+    shapes.push_back(std::make_shared<golovin::Circle>(golovin::point_t{10.0, 0.0}, 1.0));
+    golovin::MatrixShape matrix;
+    matrix.enableIndex(2.0);
+    for (const golovin::CompositeShape::shapePointer &shape : shapes)
+    {
+      matrix.addShape(shape);
+    }
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), 3);
+
+    shapes[1]->move({20.0, 0.0});
+    matrix.markChanged(shapes[1]);
+    matrix.update();
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK_EQUAL(matrix[0].getSize(), 3);
+    BOOST_REQUIRE_EQUAL(matrix[1].getSize(), 1);
+    BOOST_CHECK(matrix[1][0] == shapes[2]);
+    BOOST_CHECK(std::find(matrix[0].begin(), matrix[0].end(), shapes[1]) != matrix[0].end());
+
+    shapes[2]->move({30.0, 0.0});
+    matrix.markChanged(shapes[2]);
+    matrix.update();
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 1);
+    BOOST_CHECK_EQUAL(matrix[0].getSize(), 4);
+    BOOST_CHECK_EQUAL(matrix.getSize(), 4);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixMarkChangedErrors)
+  {
+    golovin::CompositeShape::shapePointer circle = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::MatrixShape matrix;
+    matrix.addShape(circle);
+
+    BOOST_CHECK_THROW(matrix.markChanged(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0)),
+        std::invalid_argument);
+    matrix.enableIndex(1.0);
+    BOOST_CHECK_THROW(matrix.markChanged(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0)),
+        std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixUpdateWithoutIndex)
+  {
+    golovin::CompositeShape::shapePointer first = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer second = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer third = std::make_shared<golovin::Circle>(golovin::point_t{0.5, 0.0}, 1.0);
+    golovin::MatrixShape matrix;
+    matrix.addShape(first);
+    matrix.addShape(second);
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), 2);
+
+    second->move({20.0, 0.0});
+    matrix.markChanged(second);
+    matrix.update();
+    BOOST_CHECK(!matrix.isIndexed());
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 1);
+    BOOST_CHECK_EQUAL(matrix[0].getSize(), 2);
+
+    first->move({10.0, 0.0});
+    matrix.markChanged(first);
+    matrix.update();
+    matrix.addShape(third);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 1);
+    BOOST_CHECK_EQUAL(matrix[0].getSize(), 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixMarksSurviveEnableIndex)
+  {
+    golovin::CompositeShape::shapePointer first = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer second = std::make_shared<golovin::Circle>(golovin::point_t{10.0, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer third = std::make_shared<golovin::Circle>(golovin::point_t{10.0, 0.5}, 1.0);
+    golovin::MatrixShape matrix;
+    matrix.addShape(first);
+    matrix.addShape(second);
+    matrix.markChanged(first);
+    matrix.update();
+    BOOST_REQUIRE(matrix[0][0] == second);
+
+    first->move({10.0, 0.0});
+    matrix.markChanged(first);
+    matrix.enableIndex(2.0);
+    matrix.update();
+    BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK(matrix[1][0] == first);
+    matrix.addShape(third);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 3);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixIndexWithExtremeCoordinates)
+  {
+    const double huge = std::numeric_limits<double>::max() / 4.0;
+    golovin::CompositeShape::shapePointer far = std::make_shared<golovin::Circle>(golovin::point_t{huge, -huge}, 1.0);
+    golovin::CompositeShape::shapePointer farToo = std::make_shared<golovin::Circle>(golovin::point_t{huge, 0.0}, 1.0);
+    golovin::CompositeShape::shapePointer wide = std::make_shared<golovin::Rectangle>(golovin::point_t{0.0, 0.0},
+        huge, 1.0);
+    golovin::MatrixShape matrix;
+    matrix.enableIndex(1.0);
+    matrix.addShape(far);
+    matrix.addShape(farToo);
+    matrix.addShape(wide);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 1);
+
+    far->move({0.0, 0.0});
+    matrix.markChanged(far);
+    matrix.update();
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK(matrix[1][0] == far);
+    BOOST_CHECK_EQUAL(matrix[0].getSize(), 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixInvalidCellSize)
+  {
+    golovin::MatrixShape matrix;
+
+    BOOST_CHECK_THROW(matrix.enableIndex(0.0), std::invalid_argument);
+    BOOST_CHECK(!matrix.isIndexed());
+  }
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(LayerTest)
@@ -1520,4 +2406,1177 @@ BOOST_AUTO_TEST_SUITE(LayerTest)
     BOOST_CHECK_CLOSE(moveLayer[0]->getFrameRect().height, rect.height, ACCURACY);
     BOOST_CHECK_EQUAL(layer.getSize(), 0);
   }
+
+  BOOST_AUTO_TEST_CASE(TestLayerViewTrimsTrailingNulls)
+  {
+    golovin::CompositeShape::shapeArray tmpArray(std::make_unique<golovin::CompositeShape::shapePointer[]>(4));
+    tmpArray[0] = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    tmpArray[1] = std::make_shared<golovin::Circle>(golovin::point_t{5.0, 0.0}, 1.0);
+
+    golovin::LayerView view(tmpArray.get(), 4);
+
+    BOOST_CHECK_EQUAL(view.getSize(), 2);
+    BOOST_CHECK(view[1] == tmpArray[1]);
+    BOOST_CHECK(golovin::LayerView().isEmpty());
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ThreadPoolTest)
+
+  BOOST_AUTO_TEST_CASE(TestThreadPoolRunsEveryTask)
+  {
+    golovin::ThreadPool pool(3);
+    std::vector<size_t> results(100, 0);
+    pool.run(results.size(), [&results](size_t index)
+    {
+      results[index] = index * index;
+    });
+
+    BOOST_CHECK_EQUAL(pool.getThreadCount(), 3);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(results[i], i * i);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestThreadPoolRethrowsException)
+  {
+    golovin::ThreadPool pool(2);
+
+    BOOST_CHECK_THROW(pool.run(10, [](size_t index)
+    {
+      if (index == 5)
+      {
+        throw std::logic_error("Task failed");
+      }
+    }), std::logic_error);
+    BOOST_CHECK_NO_THROW(pool.run(10, [](size_t)
+    {}));
+  }
+
+  BOOST_AUTO_TEST_CASE(TestThreadPoolNestedRun)
+  {
+    golovin::ThreadPool pool(3);
+    std::vector<size_t> results(64, 0);
+    pool.run(8, [&pool, &results](size_t row)
+    {
+      pool.run(8, [&results, row](size_t column)
+      {
+        results[row * 8 + column] = row + column;
+      });
+    });
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(results[i], i / 8 + i % 8);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestThreadPoolInvalidSize)
+  {
+    BOOST_CHECK_THROW(golovin::ThreadPool pool(0), std::invalid_argument);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(CircleBatchTest)
+  BOOST_AUTO_TEST_CASE(TestCircleBatchMatchesComposite)
+  {
+    golovin::CircleBatch batch;
+    golovin::CompositeShape composite;
+    for (size_t i = 0; i < 11; ++i)
+    {
+      const golovin::point_t center{i * 1.5, 10.0 - i * 0.75};
+      const double radius = 0.5 + i * 0.25;
+      batch.pushBack(center, radius);
+      composite.pushBack(std::make_shared<golovin::Circle>(center, radius));
+    }
+    batch.scale(1.5);
+    composite.scale(1.5);
+    batch.rotate(35.0);
+    composite.rotate(35.0);
+    batch.move({3.0, -4.0});
+    composite.move({3.0, -4.0});
+
+    BOOST_CHECK_EQUAL(batch.getSize(), 11);
+    BOOST_CHECK_CLOSE(batch.getArea(), composite.getArea(), ACCURACY);
+    const golovin::rectangle_t batchFrame = batch.getFrameRect();
+    const golovin::rectangle_t compositeFrame = composite.getFrameRect();
+    BOOST_CHECK_CLOSE(batchFrame.width, compositeFrame.width, ACCURACY);
+    BOOST_CHECK_CLOSE(batchFrame.height, compositeFrame.height, ACCURACY);
+    BOOST_CHECK_CLOSE(batchFrame.pos.x, compositeFrame.pos.x, ACCURACY);
+    BOOST_CHECK_CLOSE(batchFrame.pos.y, compositeFrame.pos.y, ACCURACY);
+    for (size_t i = 0; i < batch.getSize(); ++i)
+    {
+      BOOST_CHECK_CLOSE(batch[i].getPos().x, composite[i]->getPos().x, ACCURACY);
+      BOOST_CHECK_CLOSE(batch[i].getPos().y, composite[i]->getPos().y, ACCURACY);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCircleBatchAsCompositeChild)
+  {
+    std::shared_ptr<golovin::CircleBatch> batch = std::make_shared<golovin::CircleBatch>();
+    batch->pushBack({0.0, 0.0}, 1.0);
+    batch->pushBack({4.0, 0.0}, 1.0);
+    golovin::CompositeShape composite;
+    composite.pushBack(batch);
+    composite.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{2.0, 4.0}, 2.0, 2.0));
+
+    BOOST_CHECK_CLOSE(composite.getArea(), 2.0 * M_PI + 4.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite.getFrameRect().width, 6.0, ACCURACY);
+    BOOST_CHECK_CLOSE(composite.getFrameRect().height, 6.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCircleBatchEmptyTransforms)
+  {
+    golovin::CircleBatch batch;
+    batch.rotate(30.0);
+    batch.move({1.0, 1.0});
+    batch.scale(2.0);
+
+    BOOST_CHECK(batch.isEmpty());
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCircleBatchInvalidParameters)
+  {
+    golovin::CircleBatch batch;
+
+    BOOST_CHECK_THROW(batch.pushBack({0.0, 0.0}, -1.0), std::invalid_argument);
+    BOOST_CHECK_THROW(batch.getFrameRect(), std::logic_error);
+    BOOST_CHECK_THROW(batch[0], std::out_of_range);
+    batch.pushBack({0.0, 0.0}, 1.0);
+    BOOST_CHECK_THROW(batch.scale(0.0), std::invalid_argument);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(RectangleBatchTest)
+  BOOST_AUTO_TEST_CASE(TestRectangleBatchMatchesComposite)
+  {
+    golovin::RectangleBatch batch;
+    golovin::CompositeShape composite;
+    for (size_t i = 0; i < 9; ++i)
+    {
+      const golovin::point_t center{i * 2.0, i * i * 0.5};
+      const double width = 1.0 + i * 0.5;
+      const double height = 3.0 - i * 0.25;
+      batch.pushBack(center, width, height);
+      composite.pushBack(std::make_shared<golovin::Rectangle>(center, width, height));
+    }
+    batch.rotate(30.0);
+    composite.rotate(30.0);
+    batch.scale(2.0);
+    composite.scale(2.0);
+    batch.move(1.0, -1.0);
+    composite.move(1.0, -1.0);
+    batch.rotate(15.0);
+    composite.rotate(15.0);
+
+    BOOST_CHECK_CLOSE(batch.getArea(), composite.getArea(), ACCURACY);
+    const golovin::rectangle_t batchFrame = batch.getFrameRect();
+    const golovin::rectangle_t compositeFrame = composite.getFrameRect();
+    BOOST_CHECK_CLOSE(batchFrame.width, compositeFrame.width, ACCURACY);
+    BOOST_CHECK_CLOSE(batchFrame.height, compositeFrame.height, ACCURACY);
+    BOOST_CHECK_CLOSE(batchFrame.pos.x, compositeFrame.pos.x, ACCURACY);
+    BOOST_CHECK_CLOSE(batchFrame.pos.y, compositeFrame.pos.y, ACCURACY);
+    for (size_t i = 0; i < batch.getSize(); ++i)
+    {
+      BOOST_CHECK_CLOSE(batch[i].getFrameRect().width, composite[i]->getFrameRect().width, ACCURACY);
+      BOOST_CHECK_CLOSE(batch[i].getFrameRect().height, composite[i]->getFrameRect().height, ACCURACY);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestRectangleBatchRepeatedRotation)
+  {
+    golovin::RectangleBatch batch;
+    batch.pushBack({0.0, 0.0}, 4.0, 1.0);
+    golovin::Rectangle rectangle({0.0, 0.0}, 4.0, 1.0);
+    for (size_t i = 0; i < 10000; ++i)
+    {
+      batch.rotate(7.0);
+      rectangle.rotate(7.0);
+    }
+
+    BOOST_CHECK_CLOSE(batch.getFrameRect().width, rectangle.getFrameRect().width, ACCURACY);
+    BOOST_CHECK_CLOSE(batch.getFrameRect().height, rectangle.getFrameRect().height, ACCURACY);
+    BOOST_CHECK_CLOSE(batch[0].getFrameRect().width, rectangle.getFrameRect().width, ACCURACY);
+    BOOST_CHECK(batch.contains({1.9 * std::cos(70000.0 * M_PI / 180.0), 1.9 * std::sin(70000.0 * M_PI / 180.0)}));
+  }
+
+  BOOST_AUTO_TEST_CASE(TestRectangleBatchEmptyTransforms)
+  {
+    golovin::RectangleBatch batch;
+    batch.rotate(30.0);
+    batch.move({1.0, 1.0});
+    batch.scale(2.0);
+
+    BOOST_CHECK(batch.isEmpty());
+  }
+
+  BOOST_AUTO_TEST_CASE(TestRectangleBatchInvalidParameters)
+  {
+    golovin::RectangleBatch batch;
+
+    BOOST_CHECK_THROW(batch.pushBack({0.0, 0.0}, 1.0, 0.0), std::invalid_argument);
+    BOOST_CHECK_THROW(batch.getFrameRect(), std::logic_error);
+    BOOST_CHECK_THROW(batch[0], std::out_of_range);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(VariantCompositeShapeTest)
+  BOOST_AUTO_TEST_CASE(TestVariantCompositeMatchesComposite)
+  {
+    const golovin::point_t points[] = {{0.0, 0.0}, {4.0, 0.0}, {5.0, 3.0}, {1.0, 4.0}};
+    const golovin::Rectangle rectangle({1.0, 2.0}, 3.0, 1.0);
+    const golovin::Circle circle({-3.0, 1.0}, 1.5);
+    const golovin::Triangle triangle({0.0, 5.0}, {2.0, 7.0}, {4.0, 5.0});
+    const golovin::Polygon polygon(points, 4);
+    golovin::VariantCompositeShape variant;
+    variant.pushBack(rectangle);
+    variant.pushBack(circle);
+    variant.pushBack(triangle);
+    variant.pushBack(polygon);
+    golovin::CompositeShape composite;
+    composite.pushBack(std::make_shared<golovin::Rectangle>(rectangle));
+    composite.pushBack(std::make_shared<golovin::Circle>(circle));
+    composite.pushBack(std::make_shared<golovin::Triangle>(triangle));
+    composite.pushBack(std::make_shared<golovin::Polygon>(polygon));
+
+    variant.scale(2.0);
+    composite.scale(2.0);
+    variant.rotate(40.0);
+    composite.rotate(40.0);
+    variant.move({1.0, 1.0});
+    composite.move({1.0, 1.0});
+
+    BOOST_CHECK_EQUAL(variant.getSize(), 4);
+    BOOST_CHECK_CLOSE(variant.getArea(), composite.getArea(), ACCURACY);
+    const golovin::rectangle_t variantFrame = variant.getFrameRect();
+    const golovin::rectangle_t compositeFrame = composite.getFrameRect();
+    BOOST_CHECK_CLOSE(variantFrame.width, compositeFrame.width, ACCURACY);
+    BOOST_CHECK_CLOSE(variantFrame.height, compositeFrame.height, ACCURACY);
+    BOOST_CHECK_CLOSE(variantFrame.pos.x, compositeFrame.pos.x, ACCURACY);
+    BOOST_CHECK_CLOSE(variantFrame.pos.y, compositeFrame.pos.y, ACCURACY);
+    const golovin::Circle &movedCircle = boost::get<golovin::Circle>(variant[1]);
+    BOOST_CHECK_CLOSE(movedCircle.getPos().x, composite[1]->getPos().x, ACCURACY);
+    BOOST_CHECK_CLOSE(movedCircle.getPos().y, composite[1]->getPos().y, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestVariantCompositeErrors)
+  {
+    golovin::VariantCompositeShape variant;
+
+    BOOST_CHECK(variant.isEmpty());
+    BOOST_CHECK_THROW(variant.getFrameRect(), std::logic_error);
+    golovin::rectangle_t frame{};
+    BOOST_CHECK(!variant.tryGetFrameRect(frame));
+    BOOST_CHECK_THROW(variant.popBack(), std::logic_error);
+    BOOST_CHECK_THROW(variant[0], std::out_of_range);
+    variant.pushBack(golovin::Circle({0.0, 0.0}, 1.0));
+    BOOST_CHECK_THROW(variant.scale(-1.0), std::invalid_argument);
+    variant.popBack();
+    BOOST_CHECK(variant.isEmpty());
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ArenaTest)
+  BOOST_AUTO_TEST_CASE(TestArenaAlignmentAndRelease)
+  {
+    golovin::Arena arena(256);
+    for (size_t i = 0; i < 100; ++i)
+    {
+      void *pointer = arena.allocate(i % 7 + 1, (i % 2 == 0) ? 8 : 64);
+      BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(pointer) % ((i % 2 == 0) ? 8 : 64), 0);
+    }
+    arena.allocate(4096, 16);
+
+    BOOST_CHECK_EQUAL(arena.getAllocationCount(), 101);
+    BOOST_CHECK(arena.getBlockCount() < 10);
+    arena.release();
+    BOOST_CHECK_EQUAL(arena.getAllocationCount(), 0);
+    BOOST_CHECK_EQUAL(arena.getBlockCount(), 0);
+    BOOST_CHECK_THROW(arena.allocate(8, 3), std::invalid_argument);
+    BOOST_CHECK_THROW(golovin::Arena(0), std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestArenaBackedScene)
+  {
+    golovin::Arena arena;
+    {
+      const golovin::point_t points[] = {{0.0, 0.0}, {4.0, 0.0}, {4.0, 4.0}, {0.0, 4.0}};
+      golovin::CompositeShape composite(arena);
+      composite.pushBack(golovin::makeShape<golovin::Circle>(arena, golovin::point_t{0.0, 0.0}, 1.0));
+      composite.pushBack(golovin::makeShape<golovin::Rectangle>(arena, golovin::point_t{1.0, 0.0}, 2.0, 2.0));
+      composite.pushBack(golovin::makeShape<golovin::Polygon>(arena, points, 4, arena));
+      const size_t allocations = arena.getAllocationCount();
+
+      golovin::MatrixShape matrix(composite, arena);
+      const golovin::MatrixShape heapMatrix(composite);
+
+      BOOST_CHECK(composite.getAllocator().getArena() == &arena);
+      BOOST_CHECK(matrix.getAllocator().getArena() == &arena);
+      BOOST_CHECK(arena.getAllocationCount() > allocations);
+      BOOST_CHECK_CLOSE(composite.getArea(), M_PI + 4.0 + 16.0, ACCURACY);
+      BOOST_REQUIRE_EQUAL(matrix.getLayerCount(), heapMatrix.getLayerCount());
+      for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+      {
+        const golovin::Layer layer = matrix.getLayer(i);
+        const golovin::Layer heapLayer = heapMatrix.getLayer(i);
+        BOOST_REQUIRE_EQUAL(layer.getSize(), heapLayer.getSize());
+        for (size_t j = 0; j < layer.getSize(); ++j)
+        {
+          BOOST_CHECK_EQUAL(layer[j], heapLayer[j]);
+        }
+      }
+    }
+    arena.release();
+    BOOST_CHECK_EQUAL(arena.getUsedBytes(), 0);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(BoundingHierarchyTest)
+  BOOST_AUTO_TEST_CASE(TestHierarchyMatchesBruteForce)
+  {
+    std::mt19937 generator(21);
+    std::uniform_real_distribution<double> position(-50.0, 50.0);
+    std::uniform_real_distribution<double> side(0.5, 4.0);
+    std::vector<golovin::CompositeShape::shapePointer> leaves;
+    golovin::CompositeShape root;
+    std::shared_ptr<golovin::CompositeShape> group;
+    for (size_t i = 0; i < 300; ++i)
+    {
+      if (i % 50 == 0)
+      {
+        group = std::make_shared<golovin::CompositeShape>();
+        root.pushBack(group);
+        group->pushBack(std::make_shared<golovin::CompositeShape>());
+      }
+      leaves.push_back(std::make_shared<golovin::Rectangle>(golovin::point_t{position(generator), position(generator)},
+          side(generator), side(generator)));
+      if (i % 3 == 0)
+      {
+        root.pushBack(leaves.back());
+      }
+      else
+      {
+        group->pushBack(leaves.back());
+      }
+    }
+    golovin::BoundingHierarchy hierarchy(root);
+
+    BOOST_CHECK_EQUAL(hierarchy.getSize(), leaves.size());
+    BOOST_CHECK(hierarchy.getDepth() < 20);
+    leaves[7]->move(200.0, -200.0);
+    hierarchy.refit(leaves[7]);
+    group->move(-30.0, 10.0);
+    hierarchy.refit(group);
+    golovin::CompositeShape flat;
+    flat.append(leaves.begin(), leaves.end());
+    const golovin::rectangle_t expected = flat.getFrameRect();
+    BOOST_CHECK_CLOSE(hierarchy.getFrameRect().width, expected.width, ACCURACY);
+    BOOST_CHECK_CLOSE(hierarchy.getFrameRect().height, expected.height, ACCURACY);
+    BOOST_CHECK_CLOSE(hierarchy.getFrameRect().pos.x, expected.pos.x, ACCURACY);
+    BOOST_CHECK_CLOSE(hierarchy.getFrameRect().pos.y, expected.pos.y, ACCURACY);
+
+    const golovin::rectangle_t window{20.0, 10.0, {-10.0, 5.0}};
+    std::vector<golovin::CompositeShape::shapePointer> found;
+    hierarchy.queryRectangle(window, found);
+    size_t expectedCount = 0;
+    for (const golovin::CompositeShape::shapePointer &leaf : leaves)
+    {
+      const golovin::rectangle_t frame = leaf->getFrameRect();
+      if ((std::fabs(frame.pos.x - window.pos.x) <= (frame.width + window.width) / 2.0)
+          && (std::fabs(frame.pos.y - window.pos.y) <= (frame.height + window.height) / 2.0))
+      {
+        ++expectedCount;
+        BOOST_CHECK(std::find(found.begin(), found.end(), leaf) != found.end());
+      }
+    }
+    BOOST_CHECK_EQUAL(found.size(), expectedCount);
+    hierarchy.queryPoint(leaves[7]->getPos(), found);
+    BOOST_CHECK(std::find(found.begin(), found.end(), leaves[7]) != found.end());
+  }
+
+  BOOST_AUTO_TEST_CASE(TestHierarchyErrors)
+  {
+    golovin::CompositeShape root;
+    root.pushBack(std::make_shared<golovin::CompositeShape>());
+
+    BOOST_CHECK_THROW(golovin::BoundingHierarchy hierarchy(root), std::invalid_argument);
+    root.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    golovin::BoundingHierarchy hierarchy(root);
+    BOOST_CHECK_THROW(hierarchy.refit(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0)),
+        std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestHierarchyContaining)
+  {
+    golovin::CompositeShape root;
+    for (int i = 0; i < 40; ++i)
+    {
+      const golovin::CompositeShape::shapePointer bar
+          = std::make_shared<golovin::Rectangle>(golovin::point_t{i * 0.5, 0.0}, 4.0, 0.5);
+      bar->rotate(i * 9.0);
+      root.pushBack(bar);
+    }
+    const golovin::BoundingHierarchy hierarchy(root);
+    const golovin::point_t point{10.0, 0.2};
+
+    std::vector<golovin::CompositeShape::shapePointer> frames;
+    std::vector<golovin::CompositeShape::shapePointer> hits;
+    hierarchy.queryPoint(point, frames);
+    hierarchy.queryContaining(point, hits);
+    size_t expectedCount = 0;
+    for (size_t i = 0; i < root.getSize(); ++i)
+    {
+      if (root[i]->contains(point))
+      {
+        ++expectedCount;
+        BOOST_CHECK(std::find(hits.begin(), hits.end(), root[i]) != hits.end());
+      }
+    }
+    BOOST_CHECK_EQUAL(hits.size(), expectedCount);
+    BOOST_CHECK(expectedCount > 0);
+    BOOST_CHECK(frames.size() > hits.size());
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(CompositeSnapshotTest)
+  BOOST_AUTO_TEST_CASE(TestSnapshotCopiesOnWrite)
+  {
+    golovin::CompositeSnapshot scene;
+    for (size_t i = 0; i < 3000; ++i)
+    {
+      scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{static_cast<double>(i), 0.0}, 1.0));
+    }
+    const golovin::CompositeSnapshot snapshot(scene);
+    BOOST_CHECK_EQUAL(&snapshot[2500], &scene[2500]);
+
+    scene.edit(2500).move(0.0, 5.0);
+    BOOST_CHECK_NE(&snapshot[2500], &scene[2500]);
+    BOOST_CHECK_EQUAL(&snapshot[10], &scene[10]);
+    BOOST_CHECK_CLOSE(scene[2500].getPos().y, 5.0, ACCURACY);
+    BOOST_CHECK_SMALL(snapshot[2500].getPos().y, ACCURACY);
+
+    scene.scale(2.0);
+    BOOST_CHECK_CLOSE(scene.getArea(), 4.0 * 3000 * M_PI, ACCURACY);
+    BOOST_CHECK_CLOSE(snapshot.getArea(), 3000 * M_PI, ACCURACY);
+    BOOST_CHECK_CLOSE(snapshot.getFrameRect().width, 3001.0, ACCURACY);
+    BOOST_CHECK_EQUAL(snapshot.getSize(), 3000);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestSnapshotOfCompositeDoesNotWriteThrough)
+  {
+    const std::shared_ptr<golovin::Shape> circle = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape composite;
+    composite.pushBack(circle);
+    golovin::CompositeSnapshot snapshot(composite);
+    snapshot.move(3.0, 4.0);
+    snapshot.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{3.0, 4.0}, 1.0));
+    snapshot.popBack();
+
+    BOOST_CHECK_SMALL(circle->getPos().x, ACCURACY);
+    BOOST_CHECK_CLOSE(snapshot.getPos().x, 3.0, ACCURACY);
+    BOOST_CHECK_CLOSE(snapshot.clone()->getPos().y, 4.0, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestSnapshotOfCompositeOwnsItsShapes)
+  {
+    golovin::CompositeShape composite;
+    composite.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    const golovin::CompositeSnapshot snapshot(composite);
+    composite[0]->move(5.0, 0.0);
+    composite[0]->scale(3.0);
+
+    BOOST_CHECK_NE(&snapshot[0], composite[0].get());
+    BOOST_CHECK_SMALL(snapshot[0].getPos().x, ACCURACY);
+    BOOST_CHECK_CLOSE(snapshot.getArea(), M_PI, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestSnapshotIgnoresEditsThroughAliases)
+  {
+    const std::shared_ptr<golovin::Shape> circle = std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0);
+    golovin::CompositeShape composite;
+    composite.pushBack(circle);
+    const golovin::CompositeSnapshot fromComposite(composite);
+    golovin::CompositeSnapshot fromPushBack;
+    fromPushBack.pushBack(circle);
+    const golovin::CompositeSnapshot copy(fromPushBack);
+    circle->move(5.0, 0.0);
+    circle->scale(2.0);
+
+    BOOST_CHECK_NE(&fromPushBack[0], circle.get());
+    BOOST_CHECK_EQUAL(&copy[0], &fromPushBack[0]);
+    BOOST_CHECK_SMALL(fromComposite.getPos().x, ACCURACY);
+    BOOST_CHECK_SMALL(fromPushBack.getPos().x, ACCURACY);
+    BOOST_CHECK_CLOSE(copy.getArea(), M_PI, ACCURACY);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestSnapshotErrors)
+  {
+    golovin::CompositeSnapshot snapshot;
+
+    BOOST_CHECK_THROW(snapshot[0], std::out_of_range);
+    BOOST_CHECK_THROW(snapshot.edit(0), std::out_of_range);
+    BOOST_CHECK_THROW(snapshot.popBack(), std::logic_error);
+    BOOST_CHECK_THROW(snapshot.getFrameRect(), std::logic_error);
+    BOOST_CHECK_THROW(snapshot.pushBack(nullptr), std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestSnapshotFrameThrowsWhenNoChildReportsOne)
+  {
+    struct SilentCircle : golovin::Circle
+    {
+      using golovin::Circle::Circle;
+
+      bool tryGetFrameRect(golovin::rectangle_t &) const override
+      {
+        return false;
+      }
+    };
+    golovin::CompositeSnapshot snapshot;
+    snapshot.pushBack(std::make_shared<SilentCircle>(golovin::point_t{1.0, 1.0}, 1.0));
+
+    BOOST_CHECK_THROW(snapshot.getFrameRect(), std::logic_error);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ConcurrentCompositeShapeTest)
+  BOOST_AUTO_TEST_CASE(TestConcurrentIngestKeepsEveryShape)
+  {
+    const size_t threadCount = 4;
+    const size_t perThread = 5000;
+    golovin::ConcurrentCompositeShape scene(3);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+      threads.emplace_back([&scene, t, perThread]()
+      {
+        golovin::ConcurrentCompositeShape::Producer producer(scene);
+        for (size_t i = 0; i < perThread; ++i)
+        {
+          const golovin::point_t center{static_cast<double>(t), static_cast<double>(i)};
+          if (i % 10 == 0)
+          {
+            scene.pushBack(std::make_shared<golovin::Circle>(center, 1.0));
+          }
+          else
+          {
+            producer.pushBack(std::make_shared<golovin::Circle>(center, 1.0));
+          }
+        }
+      });
+    }
+    for (std::thread &thread : threads)
+    {
+      thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(scene.getSize(), threadCount * perThread);
+    const golovin::CompositeShape composite = scene.seal();
+    BOOST_CHECK_EQUAL(scene.getSize(), 0);
+    BOOST_REQUIRE_EQUAL(composite.getSize(), threadCount * perThread);
+    std::set<std::pair<double, double>> centers;
+    for (size_t i = 0; i < composite.getSize(); ++i)
+    {
+      centers.insert({composite[i]->getPos().x, composite[i]->getPos().y});
+    }
+    BOOST_CHECK_EQUAL(centers.size(), threadCount * perThread);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMovedFromProducer)
+  {
+    golovin::ConcurrentCompositeShape scene(2);
+    golovin::ConcurrentCompositeShape::Producer producer(scene);
+    producer.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    golovin::ConcurrentCompositeShape::Producer moved(std::move(producer));
+
+    BOOST_CHECK_THROW(producer.flush(), std::logic_error);
+    BOOST_CHECK_THROW(producer.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0)),
+        std::logic_error);
+    moved.flush();
+    BOOST_CHECK_EQUAL(scene.seal().getSize(), 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestConcurrentProducersKeepTheirOrder)
+  {
+    const size_t threadCount = 6;
+    const size_t perThread = 5000;
+    golovin::ConcurrentCompositeShape scene(4);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t)
+    {
+      threads.emplace_back([&scene, t, perThread]()
+      {
+        golovin::ConcurrentCompositeShape::Producer producer(scene);
+        for (size_t i = 0; i < perThread; ++i)
+        {
+          producer.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{static_cast<double>(t),
+              static_cast<double>(i)}, 1.0));
+        }
+        producer.flush();
+      });
+    }
+    for (std::thread &thread : threads)
+    {
+      thread.join();
+    }
+
+    const golovin::CompositeShape composite = scene.seal();
+    BOOST_REQUIRE_EQUAL(composite.getSize(), threadCount * perThread);
+    std::vector<double> lastY(threadCount, -1.0);
+    for (size_t i = 0; i < composite.getSize(); ++i)
+    {
+      const golovin::point_t pos = composite[i]->getPos();
+      const size_t thread = static_cast<size_t>(pos.x);
+      BOOST_CHECK_GT(pos.y, lastY[thread]);
+      lastY[thread] = pos.y;
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestConcurrentCompositeErrors)
+  {
+    BOOST_CHECK_THROW(golovin::ConcurrentCompositeShape scene(0), std::invalid_argument);
+    golovin::ConcurrentCompositeShape scene(2);
+    golovin::ConcurrentCompositeShape::Producer producer(scene);
+
+    BOOST_CHECK_THROW(scene.pushBack(nullptr), std::invalid_argument);
+    BOOST_CHECK_THROW(producer.pushBack(nullptr), std::invalid_argument);
+    BOOST_CHECK(scene.seal().isEmpty());
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SweepAndPruneTest)
+  BOOST_AUTO_TEST_CASE(TestPairsMatchBruteForce)
+  {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> position(0.0, 40.0);
+    std::uniform_real_distribution<double> side(0.5, 4.0);
+    std::uniform_real_distribution<double> step(-0.5, 0.5);
+    golovin::CompositeShape scene;
+    for (int i = 0; i < 200; ++i)
+    {
+      scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{position(generator), position(generator)},
+          side(generator), side(generator)));
+    }
+    golovin::SweepAndPrune broadPhase;
+    std::vector<golovin::SweepAndPrune::pair_t> pairs;
+    for (int frame = 0; frame < 5; ++frame)
+    {
+      broadPhase.update(scene, pairs);
+      std::set<std::pair<size_t, size_t>> found;
+      for (const golovin::SweepAndPrune::pair_t &pair : pairs)
+      {
+        BOOST_CHECK(pair.first < pair.second);
+        found.insert({pair.first, pair.second});
+      }
+      BOOST_CHECK_EQUAL(found.size(), pairs.size());
+      size_t expectedCount = 0;
+      for (size_t i = 0; i < scene.getSize(); ++i)
+      {
+        for (size_t j = i + 1; j < scene.getSize(); ++j)
+        {
+          if (golovin::SweepAndPrune::isOverlapped(scene[i]->getFrameRect(), scene[j]->getFrameRect()))
+          {
+            ++expectedCount;
+            BOOST_CHECK(found.count({i, j}) == 1);
+          }
+        }
+      }
+      BOOST_CHECK_EQUAL(pairs.size(), expectedCount);
+      for (size_t i = 0; i < scene.getSize(); ++i)
+      {
+        scene[i]->move(step(generator), step(generator));
+      }
+    }
+    BOOST_CHECK_EQUAL(broadPhase.getSize(), scene.getSize());
+    BOOST_CHECK(broadPhase.getSwapCount() < scene.getSize());
+  }
+
+  BOOST_AUTO_TEST_CASE(TestTouchingFramesAgreeWithMatrix)
+  {
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{0.0, 0.0}, 2.0, 2.0));
+    scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{2.0, 0.0}, 2.0, 2.0));
+    scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{3.5, 1.0}, 2.0, 2.0));
+    golovin::SweepAndPrune broadPhase;
+    std::vector<golovin::SweepAndPrune::pair_t> pairs;
+    broadPhase.update(scene, pairs);
+
+    BOOST_REQUIRE_EQUAL(pairs.size(), 1);
+    BOOST_CHECK_EQUAL(pairs.front().first, 1);
+    BOOST_CHECK_EQUAL(pairs.front().second, 2);
+    const golovin::MatrixShape matrix(scene);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK_EQUAL(matrix[0].getSize(), 2);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestPooledSweepMatchesSequential)
+  {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> position(0.0, 100.0);
+    std::uniform_real_distribution<double> side(0.5, 4.0);
+    std::vector<golovin::rectangle_t> frames;
+    for (int i = 0; i < 2000; ++i)
+    {
+      frames.push_back({side(generator), side(generator), {position(generator), position(generator)}});
+    }
+    golovin::SweepAndPrune sequential;
+    golovin::SweepAndPrune pooled;
+    golovin::ThreadPool pool(3);
+    std::vector<golovin::SweepAndPrune::pair_t> expected;
+    std::vector<golovin::SweepAndPrune::pair_t> pairs;
+    sequential.update(frames, expected);
+    pooled.update(frames, pairs, &pool);
+
+    std::set<std::pair<size_t, size_t>> found;
+    for (const golovin::SweepAndPrune::pair_t &pair : pairs)
+    {
+      found.insert({pair.first, pair.second});
+    }
+    BOOST_CHECK_EQUAL(found.size(), pairs.size());
+    BOOST_CHECK_EQUAL(pairs.size(), expected.size());
+    for (const golovin::SweepAndPrune::pair_t &pair : expected)
+    {
+      BOOST_CHECK(found.count({pair.first, pair.second}) == 1);
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestResizeAndErrors)
+  {
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    golovin::SweepAndPrune broadPhase;
+    std::vector<golovin::SweepAndPrune::pair_t> pairs;
+
+    broadPhase.update(scene, pairs);
+    BOOST_CHECK(pairs.empty());
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{1.5, 0.0}, 1.0));
+    broadPhase.update(scene, pairs);
+    BOOST_CHECK_EQUAL(pairs.size(), 1);
+    BOOST_CHECK_EQUAL(pairs.front().first, 0);
+    BOOST_CHECK_EQUAL(pairs.front().second, 1);
+    scene.pushBack(std::make_shared<golovin::CompositeShape>());
+    BOOST_CHECK_THROW(broadPhase.update(scene, pairs), std::logic_error);
+    broadPhase.clear();
+    BOOST_CHECK_EQUAL(broadPhase.getSize(), 0);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SceneFormatTest)
+  BOOST_AUTO_TEST_CASE(TestCompositeRoundTrip)
+  {
+    golovin::point_t points[] = {{-1.0, 1.0}, {2.0, 5.0}, {5.0, 4.0}, {4.0, 2.0}};
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    nested->pushBack(std::make_shared<golovin::Triangle>(golovin::point_t{0.0, 0.0}, golovin::point_t{4.0, 0.0},
+        golovin::point_t{0.0, 3.0}));
+    nested->pushBack(std::make_shared<golovin::CompositeShape>());
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 2.0}, 3.0, 4.0));
+    scene[0]->rotate(30.0);
+    scene.pushBack(nested);
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{-5.0, 1.0}, 2.0));
+    scene.pushBack(std::make_shared<golovin::Polygon>(points, 4));
+
+    std::stringstream stream;
+    golovin::scene::save(stream, scene);
+    const std::string bytes = stream.str();
+    golovin::Arena arena;
+    const golovin::CompositeShape loaded = golovin::scene::loadComposite(stream, arena);
+
+    BOOST_CHECK_EQUAL(loaded.getSize(), scene.getSize());
+    BOOST_CHECK_CLOSE(loaded.getArea(), scene.getArea(), ACCURACY);
+    BOOST_CHECK_CLOSE(loaded[0]->getFrameRect().width, scene[0]->getFrameRect().width, ACCURACY);
+    BOOST_CHECK_CLOSE(loaded[3]->getFrameRect().pos.y, scene[3]->getFrameRect().pos.y, ACCURACY);
+    BOOST_CHECK(arena.getAllocationCount() > 0);
+    std::stringstream copy;
+    golovin::scene::save(copy, loaded);
+    BOOST_CHECK(copy.str() == bytes);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixRoundTrip)
+  {
+    golovin::CompositeShape scene;
+    for (int i = 0; i < 30; ++i)
+    {
+      scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{i * 0.7, (i % 3) * 0.5}, 1.0));
+    }
+    golovin::MatrixShape matrix(scene);
+    matrix.enableIndex(2.0);
+    scene[4]->move(50.0, 0.0);
+    matrix.markChanged(scene[4]);
+    matrix.update();
+
+    std::stringstream stream;
+    golovin::scene::save(stream, matrix);
+    const golovin::MatrixShape loaded = golovin::scene::loadMatrix(stream);
+
+    BOOST_REQUIRE_EQUAL(loaded.getLayerCount(), matrix.getLayerCount());
+    for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(loaded[i].getSize(), matrix[i].getSize());
+      for (size_t j = 0; j < matrix[i].getSize(); ++j)
+      {
+        BOOST_CHECK_CLOSE(loaded[i][j]->getPos().x, matrix[i][j]->getPos().x, ACCURACY);
+        BOOST_CHECK_CLOSE(loaded[i][j]->getPos().y, matrix[i][j]->getPos().y, ACCURACY);
+      }
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE(TestInvalidScenes)
+  {
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::CircleBatch>());
+    std::stringstream unsupported;
+    BOOST_CHECK_THROW(golovin::scene::save(unsupported, scene), std::invalid_argument);
+
+    scene.popBack();
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    std::stringstream stream;
+    golovin::scene::save(stream, scene);
+    const std::string bytes = stream.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 8));
+    BOOST_CHECK_THROW(golovin::scene::loadComposite(truncated), std::invalid_argument);
+    std::stringstream wrongKind(bytes);
+    BOOST_CHECK_THROW(golovin::scene::loadMatrix(wrongKind), std::invalid_argument);
+    std::stringstream garbage("not a scene at all");
+    BOOST_CHECK_THROW(golovin::scene::loadComposite(garbage), std::invalid_argument);
+    std::string corrupted = bytes;
+    corrupted[corrupted.size() - 8] = 1;
+    std::stringstream invalid(corrupted);
+    BOOST_CHECK_THROW(golovin::scene::loadComposite(invalid), std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestScenesThatCannotLoadBack)
+  {
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Triangle>(golovin::point_t{0.0, 0.0}, golovin::point_t{1.0, 0.0},
+        golovin::point_t{0.0, 1.0}));
+    scene[0]->scale(1e-5);
+    std::stringstream tiny;
+    BOOST_CHECK_THROW(golovin::scene::save(tiny, scene), std::invalid_argument);
+    BOOST_CHECK(tiny.str().empty());
+
+    golovin::CompositeShape deep;
+    std::vector<golovin::CompositeShape *> chain{&deep};
+    for (size_t i = 0; i <= golovin::scene::MAX_DEPTH; ++i)
+    {
+      chain.push_back(&chain.back()->emplaceBack<golovin::CompositeShape>());
+    }
+    std::stringstream tooDeep;
+    BOOST_CHECK_THROW(golovin::scene::save(tooDeep, deep), std::invalid_argument);
+    chain[chain.size() - 2]->popBack();
+    std::stringstream stream;
+    golovin::scene::save(stream, deep);
+    BOOST_CHECK_EQUAL(golovin::scene::loadComposite(stream).getSize(), 1);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestCorruptedNestingAndLayers)
+  {
+    std::stringstream empty;
+    golovin::scene::save(empty, golovin::CompositeShape());
+    const std::string header = empty.str().substr(0, sizeof(golovin::scene::header_t));
+    auto writeColumn = [](std::ostream &out, const auto &column)
+    {
+      const uint64_t count = column.size();
+      const uint64_t bytes = count * sizeof(column[0]);
+      const char padding[8] = {};
+      out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+      out.write(reinterpret_cast<const char *>(column.data()), bytes);
+      out.write(padding, (8 - bytes % 8) % 8);
+    };
+    const size_t depth = golovin::scene::MAX_DEPTH + 2;
+    std::stringstream deep;
+    deep << header;
+    writeColumn(deep, std::vector<uint8_t>(depth, golovin::scene::COMPOSITE_TAG));
+    std::vector<uint64_t> childCounts(depth, 1);
+    childCounts.back() = 0;
+    writeColumn(deep, childCounts);
+    writeColumn(deep, std::vector<uint64_t>());
+    writeColumn(deep, std::vector<uint64_t>(1, 1));
+    writeColumn(deep, std::vector<golovin::scene::cursor_t>(1, golovin::scene::cursor_t{1, 1, 0, 0, 0, 0, 0}));
+    for (size_t i = 0; i < 4; ++i)
+    {
+      writeColumn(deep, std::vector<double>());
+    }
+    BOOST_CHECK_THROW(golovin::scene::loadComposite(deep), std::invalid_argument);
+
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{0.0, 0.0}, 1.0));
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{1.0, 0.0}, 1.0));
+    std::vector<size_t> rows{0, 2};
+    BOOST_CHECK_THROW(golovin::MatrixShape(scene, rows), std::invalid_argument);
+    rows[1] = 1;
+    golovin::Arena arena;
+    const golovin::MatrixShape matrix(scene, rows, arena);
+    BOOST_CHECK_EQUAL(matrix.getLayerCount(), 2);
+    BOOST_CHECK_EQUAL(matrix.getAllocator().getArena(), &arena);
+    std::stringstream stream;
+    golovin::scene::save(stream, matrix);
+    BOOST_CHECK_EQUAL(golovin::scene::loadMatrix(stream, arena).getAllocator().getArena(), &arena);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SceneViewTest)
+  BOOST_AUTO_TEST_CASE(TestCompositeQueries)
+  {
+    golovin::point_t points[] = {{-1.0, 1.0}, {2.0, 5.0}, {5.0, 4.0}, {4.0, 2.0}};
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    nested->pushBack(std::make_shared<golovin::Triangle>(golovin::point_t{0.0, 0.0}, golovin::point_t{4.0, 0.0},
+        golovin::point_t{0.0, 3.0}));
+    nested->pushBack(std::make_shared<golovin::Polygon>(points, 4));
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 2.0}, 3.0, 4.0));
+    scene[0]->rotate(30.0);
+    scene.pushBack(nested);
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{-5.0, 1.0}, 2.0));
+    const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+      std::ofstream out(path.string(), std::ios::binary);
+      golovin::scene::save(out, scene);
+    }
+
+    {
+      const golovin::SceneView view(path.string());
+      BOOST_CHECK(!view.isMatrix());
+      BOOST_CHECK_EQUAL(view.getSize(), scene.getSize());
+      BOOST_CHECK_EQUAL(view.getLayerCount(), 1);
+      BOOST_CHECK_CLOSE(view.getArea(), scene.getArea(), ACCURACY);
+      BOOST_CHECK_CLOSE(view.getFrameRect().width, scene.getFrameRect().width, ACCURACY);
+      BOOST_CHECK_CLOSE(view.getFrameRect().pos.y, scene.getFrameRect().pos.y, ACCURACY);
+      const golovin::point_t probes[] = {{1.0, 2.0}, {3.5, 4.0}, {-6.5, 1.0}, {2.5, 4.5}, {-2.0, 4.0}, {0.5, 0.5}};
+      for (const golovin::point_t &probe : probes)
+      {
+        BOOST_CHECK_EQUAL(view.contains(probe), scene.contains(probe));
+      }
+
+      std::vector<golovin::ShapeRecord> records;
+      view.getLayer(0, records);
+      BOOST_REQUIRE_EQUAL(records.size(), scene.getSize());
+      BOOST_CHECK_EQUAL(records[1].getType(), golovin::scene::COMPOSITE_TAG);
+      for (size_t i = 0; i < records.size(); ++i)
+      {
+        BOOST_CHECK_CLOSE(records[i].getArea(), scene[i]->getArea(), ACCURACY);
+        BOOST_CHECK_CLOSE(records[i].getFrameRect().pos.x, scene[i]->getFrameRect().pos.x, ACCURACY);
+        BOOST_CHECK_CLOSE(records[i].getFrameRect().height, scene[i]->getFrameRect().height, ACCURACY);
+        BOOST_CHECK_EQUAL(records[i].contains({3.5, 4.0}), scene[i]->contains({3.5, 4.0}));
+      }
+      BOOST_CHECK_THROW(view.getLayerSize(1), std::out_of_range);
+    }
+    boost::filesystem::remove(path);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestEmptyNestedCompositeMatchesLoaded)
+  {
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    nested->pushBack(std::make_shared<golovin::Circle>(golovin::point_t{3.0, 0.0}, 1.0));
+    nested->pushBack(std::make_shared<golovin::CompositeShape>());
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{0.0, 0.0}, 2.0, 2.0));
+    scene.pushBack(nested);
+    const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+      std::ofstream out(path.string(), std::ios::binary);
+      golovin::scene::save(out, scene);
+    }
+
+    {
+      std::ifstream in(path.string(), std::ios::binary);
+      const golovin::CompositeShape loaded = golovin::scene::loadComposite(in);
+      const golovin::SceneView view(path.string());
+      BOOST_CHECK_THROW(loaded.getFrameRect(), std::logic_error);
+      BOOST_CHECK_THROW(view.getFrameRect(), std::logic_error);
+      BOOST_CHECK_CLOSE(view.getArea(), loaded.getArea(), ACCURACY);
+      std::vector<golovin::ShapeRecord> records;
+      view.getLayer(0, records);
+      BOOST_REQUIRE_EQUAL(records.size(), 2);
+      BOOST_CHECK_CLOSE(records[0].getFrameRect().width, 2.0, ACCURACY);
+      BOOST_CHECK_THROW(loaded[1]->getFrameRect(), std::logic_error);
+      BOOST_CHECK_THROW(records[1].getFrameRect(), std::logic_error);
+    }
+    boost::filesystem::remove(path);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixLayers)
+  {
+    golovin::CompositeShape scene;
+    for (int i = 0; i < 20; ++i)
+    {
+      scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{i * 0.7, 0.0}, 1.0));
+    }
+    const golovin::MatrixShape matrix(scene);
+    const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+      std::ofstream out(path.string(), std::ios::binary);
+      golovin::scene::save(out, matrix);
+    }
+
+    {
+      const golovin::SceneView view(path.string());
+      BOOST_CHECK(view.isMatrix());
+      BOOST_REQUIRE_EQUAL(view.getLayerCount(), matrix.getLayerCount());
+      std::vector<golovin::ShapeRecord> records;
+      for (size_t i = 0; i < matrix.getLayerCount(); ++i)
+      {
+        view.getLayer(i, records);
+        BOOST_REQUIRE_EQUAL(records.size(), matrix[i].getSize());
+        for (size_t j = 0; j < records.size(); ++j)
+        {
+          BOOST_CHECK_CLOSE(records[j].getFrameRect().pos.x, matrix[i][j]->getPos().x, ACCURACY);
+        }
+      }
+    }
+    boost::filesystem::remove(path);
+    BOOST_CHECK_THROW(golovin::SceneView view(path.string()), std::runtime_error);
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SceneTextTest)
+  BOOST_AUTO_TEST_CASE(TestParseShapes)
+  {
+    std::stringstream text;
+    text << "# scene dump\n"
+        << "RECTANGLE (1 2, 3 4, 90)\r\n"
+        << "\n"
+        << "circle(-5 1.5e0, 2)\n"
+        << "TRIANGLE ((0 0, 4 0, 0 3, 0 0))\n"
+        << "POLYGON ((-1 1, 2 5, 5 4, 4 2, -1 1))\n"
+        << "polygon -1 1 2 5 5 4 4 2 0.000000000000000000001";
+    golovin::CompositeShape scene;
+
+    BOOST_CHECK_THROW(golovin::scene::parseText(text, scene), std::invalid_argument);
+    BOOST_CHECK_EQUAL(scene.getSize(), 4);
+
+    text.clear();
+    text.str("RECTANGLE (1 2, 3 4, 90)\ncircle(-5 1.5e0, 2)\nTRIANGLE ((0 0, 4 0, 0 3, 0 0))\n"
+        "  POLYGON ((-1 1, 2 5, 5 4, 4 2, -1 1))\n-12.5e-1 0.125 3");
+    golovin::CompositeShape chunked;
+    BOOST_CHECK_THROW(golovin::scene::parseText(text, chunked, 8), std::invalid_argument);
+    BOOST_REQUIRE_EQUAL(chunked.getSize(), 4);
+    BOOST_CHECK_CLOSE(chunked[0]->getFrameRect().width, 4.0, ACCURACY);
+    BOOST_CHECK_CLOSE(chunked[1]->getArea(), M_PI * 4.0, ACCURACY);
+    BOOST_CHECK_CLOSE(chunked[1]->getPos().y, 1.5, ACCURACY);
+    BOOST_CHECK_CLOSE(chunked[2]->getArea(), 6.0, ACCURACY);
+    BOOST_CHECK_CLOSE(chunked[3]->getArea(), scene[3]->getArea(), ACCURACY);
+
+    text.clear();
+    text.str("circle 0.1 -3.25e2 0.30000000000000004441\ncircle 1e300 0 12345678901234567890");
+    golovin::CompositeShape precise;
+    BOOST_CHECK_EQUAL(golovin::scene::parseText(text, precise), 2);
+    BOOST_CHECK_EQUAL(precise[0]->getPos().x, 0.1);
+    BOOST_CHECK_EQUAL(precise[0]->getPos().y, -325.0);
+    BOOST_CHECK_EQUAL(precise[0]->getFrameRect().width, 2 * 0.30000000000000004441);
+    BOOST_CHECK_EQUAL(precise[1]->getPos().x, 1e300);
+    BOOST_CHECK_EQUAL(precise[1]->getFrameRect().width, 2 * 12345678901234567890.0);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestParseCommentsAndLocale)
+  {
+    struct CommaPoint : std::numpunct<char>
+    {
+      char do_decimal_point() const override
+      {
+        return ',';
+      }
+    };
+    std::stringstream text("circle 0 0 1 # unit circle\nRECTANGLE (1 2, 3 4)# box\n"
+        "circle 0.12345678901234567890 1e-400 1\n");
+    golovin::CompositeShape scene;
+    const std::locale previous = std::locale::global(std::locale(std::locale::classic(), new CommaPoint));
+    const size_t count = golovin::scene::parseText(text, scene);
+    std::locale::global(previous);
+
+    BOOST_CHECK_EQUAL(count, 3);
+    BOOST_REQUIRE_EQUAL(scene.getSize(), 3);
+    BOOST_CHECK_CLOSE(scene[1]->getArea(), 12.0, ACCURACY);
+    BOOST_CHECK_EQUAL(scene[2]->getPos().x, 0.12345678901234567890);
+    text.clear();
+    text.str("circle 0 1e400 1\n");
+    BOOST_CHECK_THROW(golovin::scene::parseText(text, scene), std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestParseErrors)
+  {
+    const std::string invalid[] = {"HEXAGON (0 0, 1)", "CIRCLE (0 0, -1)", "CIRCLE (0 0, 1x)", "CIRCLE (0 0)",
+        "TRIANGLE ((0 0, 1 1, 2 2))", "POLYGON ((0 0, 4 0, 1 1, 0 4))", "POLYGON ((0 0, 4 0, 4))"};
+    for (const std::string &line : invalid)
+    {
+      std::stringstream text("circle 0 0 1\n" + line + "\n");
+      golovin::CompositeShape scene;
+      try
+      {
+        golovin::scene::parseText(text, scene);
+        BOOST_ERROR("No error for " + line);
+      }
+      catch (const std::invalid_argument &error)
+      {
+        BOOST_CHECK_EQUAL(std::string(error.what()), "Failed to parse line 2");
+        BOOST_CHECK_THROW(std::rethrow_if_nested(error), std::invalid_argument);
+      }
+      BOOST_CHECK_EQUAL(scene.getSize(), 1);
+    }
+  }
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SvgWriterTest)
+  BOOST_AUTO_TEST_CASE(TestCompositeDocument)
+  {
+    golovin::point_t points[] = {{-1.0, 1.0}, {2.0, 5.0}, {5.0, 4.0}, {4.0, 2.0}};
+    std::shared_ptr<golovin::CompositeShape> nested = std::make_shared<golovin::CompositeShape>();
+    nested->pushBack(std::make_shared<golovin::Triangle>(golovin::point_t{0.0, 0.0}, golovin::point_t{4.0, 0.0},
+        golovin::point_t{0.0, 3.0}));
+    nested->pushBack(std::make_shared<golovin::Polygon>(points, 4));
+    golovin::CompositeShape scene;
+    scene.pushBack(std::make_shared<golovin::Rectangle>(golovin::point_t{1.0, 2.0}, 3.0, 4.0));
+    scene[0]->rotate(30.0);
+    scene.pushBack(nested);
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{-5.0, 1.5}, 2.0000004));
+    scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{-0.0000001, 1e15}, 0.125));
+
+    golovin::SvgWriter writer;
+    std::stringstream document;
+    writer.write(document, scene);
+    const std::string text = document.str();
+
+    BOOST_CHECK_EQUAL(text.find("<svg "), 0);
+    BOOST_CHECK(text.find("<rect x=\"-0.5\" y=\"0\" width=\"3\" height=\"4\" transform=\"rotate(30 1 2)\"/>")
+        != std::string::npos);
+    BOOST_CHECK(text.find("<g>\n<polygon points=\"0,0 4,0 0,3 \"/>\n<polygon points=\"-1,1 2,5 5,4 4,2 \"/>\n</g>")
+        != std::string::npos);
+    BOOST_CHECK(text.find("<circle cx=\"-5\" cy=\"1.5\" r=\"2\"/>") != std::string::npos);
+    BOOST_CHECK(text.find("<circle cx=\"0\" cy=\"1000000000000000\" r=\"0.125\"/>") != std::string::npos);
+    BOOST_CHECK(text.rfind("</svg>\n") == text.size() - 7);
+
+    golovin::SvgWriter smallWriter(32);
+    std::stringstream smallDocument;
+    smallWriter.write(smallDocument, scene);
+    BOOST_CHECK(smallDocument.str() == text);
+    std::stringstream again;
+    writer.write(again, scene);
+    BOOST_CHECK(again.str() == text);
+    BOOST_CHECK_THROW(golovin::SvgWriter tiny(4), std::invalid_argument);
+  }
+
+  BOOST_AUTO_TEST_CASE(TestMatrixLayers)
+  {
+    golovin::CompositeShape scene;
+    for (int i = 0; i < 10; ++i)
+    {
+      scene.pushBack(std::make_shared<golovin::Circle>(golovin::point_t{i * 0.5, 0.0}, 1.0));
+    }
+    const golovin::MatrixShape matrix(scene);
+    golovin::SvgWriter writer;
+    std::stringstream document;
+    writer.write(document, matrix);
+    const std::string text = document.str();
+
+    size_t groups = 0;
+    for (size_t position = text.find("<g id=\"layer-"); position != std::string::npos;
+        position = text.find("<g id=\"layer-", position + 1))
+    {
+      ++groups;
+    }
+    BOOST_CHECK_EQUAL(groups, matrix.getLayerCount());
+    BOOST_CHECK(text.find("<g id=\"layer-1\">\n<circle cx=\"0.5\" cy=\"0\" r=\"1\"/>") != std::string::npos);
+    const std::string lastLayer = "<g id=\"layer-" + std::to_string(matrix.getLayerCount() - 1) + "\">";
+    BOOST_CHECK(text.find(lastLayer) != std::string::npos);
+  }
 BOOST_AUTO_TEST_SUITE_END()